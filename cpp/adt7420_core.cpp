@@ -0,0 +1,260 @@
+/*****************************************************************//**
+ * @file adt7420_core.cpp
+ *
+ * @brief implementation of Adt7420 class
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include "adt7420_core.h"
+
+Adt7420::Adt7420(I2cCore *i2c_p, uint8_t dev_addr) {
+   i2c = i2c_p;
+   dev = dev_addr;
+   dev_id = 0;
+   config = 0;    // power-on default: 13-bit, continuous
+   ptr = -1;
+   xfer.status = I2cCore::XFER_IDLE;
+   xfer_reg = TEMP_REG;
+   xfer_new = 0;
+   xfer_tries = 0;
+   rec_xfer.status = I2cCore::XFER_IDLE;
+   rec_xfer.done = 0;
+   last_raw = 0;
+   stale_flag = 0;
+   clear_stats();
+}
+
+Adt7420::~Adt7420() {
+}
+
+int Adt7420::init() {
+   uint8_t data;
+   int rc;
+
+   ptr = -1;
+   rc = read_reg(ID_REG, &data, 1);
+   if (rc != 0)
+      return (rc);
+   dev_id = data;
+   if (dev_id != DEV_ID)
+      return (-1);
+   rc = read_reg(CONFIG_REG, &data, 1);
+   if (rc != 0)
+      return (rc);
+   config = data;
+   return (0);
+}
+
+int Adt7420::id() {
+   return (dev_id);
+}
+
+void Adt7420::clear_stats() {
+   st.reads = 0;
+   st.nack = 0;
+   st.timeout = 0;
+   st.retries = 0;
+   st.recoveries = 0;
+   st.stale = 0;
+}
+
+// finish pending asynchronous transactions (read and recovery)
+// before a blocking access
+void Adt7420::sync() {
+   while (i2c->xfer_busy())
+      i2c->poll();
+}
+
+// count a failed access; pointer unknown; recover after a time-out
+int Adt7420::fail(int rc) {
+   ptr = -1;
+   if (rc == I2cCore::I2C_ERR_TIMEOUT) {
+      st.timeout++;
+      st.recoveries++;
+      i2c->recover();
+   } else {
+      st.nack++;
+   }
+   return (rc);
+}
+
+// move the device address pointer (pointer-only write)
+int Adt7420::set_ptr(uint8_t reg) {
+   int rc;
+
+   if (ptr == reg)
+      return (0);
+   rc = i2c->write_transaction(dev, &reg, 1, 1);
+   if (rc != 0)
+      return (rc);
+   ptr = reg;
+   return (0);
+}
+
+int Adt7420::read_reg(uint8_t reg, uint8_t *data, int num) {
+   int rc = 0, n;
+
+   sync();
+   for (n = 0; n < READ_TRIES; n++) {
+      if (n > 0)
+         st.retries++;
+      rc = set_ptr(reg);
+      // auto-increment within the read; pointer itself not moved
+      if (rc == 0)
+         rc = i2c->read_transaction(dev, data, num, 0);
+      if (rc == 0)
+         return (0);
+      fail(rc);
+   }
+   return (rc);
+}
+
+int Adt7420::write_reg(uint8_t reg, uint8_t data) {
+   uint8_t bytes[2];
+   int rc = 0, n;
+
+   bytes[0] = reg;
+   bytes[1] = data;
+   sync();
+   for (n = 0; n < READ_TRIES; n++) {
+      if (n > 0)
+         st.retries++;
+      rc = i2c->write_transaction(dev, bytes, 2, 0);
+      if (rc == 0) {
+         ptr = reg;   // pointer left at the register written
+         return (0);
+      }
+      fail(rc);
+   }
+   return (rc);
+}
+
+int Adt7420::set_config(int res16, int mode) {
+   uint8_t data;
+   int rc;
+
+   data = (config & ~(RES_16BIT | MODE_FIELD)) | (mode & MODE_FIELD);
+   if (res16)
+      data = data | RES_16BIT;
+   rc = write_reg(CONFIG_REG, data);
+   if (rc != 0)
+      return (rc);
+   config = data;
+   return (0);
+}
+
+int Adt7420::res16() {
+   return ((config & RES_16BIT) ? 1 : 0);
+}
+
+// record the outcome of a temperature read
+void Adt7420::sample(int rc, uint16_t raw) {
+   st.reads++;
+   if (rc == 0) {
+      last_raw = raw;
+      stale_flag = 0;
+   } else {
+      stale_flag = 1;
+      st.stale++;
+   }
+}
+
+int Adt7420::read_raw(uint16_t *raw) {
+   uint8_t bytes[2];
+   uint16_t r = 0;
+   int rc;
+
+   rc = read_reg(TEMP_REG, bytes, 2);
+   if (rc == 0) {
+      r = (uint16_t) ((bytes[0] << 8) | bytes[1]);
+      *raw = r;
+   }
+   sample(rc, r);
+   return (rc);
+}
+
+float Adt7420::read(uint16_t *raw) {
+   uint16_t r;
+
+   if (read_raw(&r) != 0)
+      r = last_raw;
+   if (raw)
+      *raw = r;
+   return (raw_to_c(r, res16()));
+}
+
+Temperature Adt7420::read_temp(uint16_t *raw) {
+   uint16_t r;
+
+   if (read_raw(&r) != 0)
+      r = last_raw;
+   if (raw)
+      *raw = r;
+   return (Temperature::from_raw(r, res16()));
+}
+
+int Adt7420::stale() {
+   return (stale_flag);
+}
+
+// completion callback of the asynchronous read; a failed attempt is
+// resubmitted up to READ_TRIES attempts in all, after a queued bus
+// recovery if it timed out
+void Adt7420::read_done(I2cXfer *x) {
+   Adt7420 *self = (Adt7420 *) x->arg;
+
+   if (x->status == I2cCore::XFER_DONE) {
+      self->ptr = TEMP_REG;
+      self->sample(0, (uint16_t) ((self->xfer_data[0] << 8) | self->xfer_data[1]));
+      self->xfer_new = 1;
+      return;
+   }
+   self->ptr = -1;
+   if (x->status == I2cCore::XFER_TIMEOUT) {
+      self->st.timeout++;
+      // already queued if pending: it runs before the next attempt
+      if (self->i2c->submit_recover(&self->rec_xfer) == 0)
+         self->st.recoveries++;
+   } else {
+      self->st.nack++;
+   }
+   self->xfer_tries++;
+   if (self->xfer_tries < READ_TRIES) {
+      self->st.retries++;
+      x->wr_num = 1;    // pointer unknown: write it again
+      self->i2c->submit(x);
+      return;
+   }
+   self->sample(-1, 0);
+   self->xfer_new = 1;
+}
+
+int Adt7420::read_start() {
+   if (read_busy())
+      return (-1);
+   xfer.dev = dev;
+   xfer.wr = &xfer_reg;
+   xfer.wr_num = (ptr == TEMP_REG) ? 0 : 1;
+   xfer.rd = xfer_data;
+   xfer.rd_num = 2;
+   xfer.restart = 0;
+   xfer.done = read_done;
+   xfer.arg = this;
+   xfer_new = 0;
+   xfer_tries = 0;
+   return (i2c->submit(&xfer));
+}
+
+int Adt7420::read_busy() {
+   return (xfer.status == I2cCore::XFER_QUEUED
+         || xfer.status == I2cCore::XFER_BUSY);
+}
+
+int Adt7420::read_result(uint16_t *raw) {
+   if (!xfer_new)
+      return (-1);
+   xfer_new = 0;
+   *raw = last_raw;
+   return (stale_flag);
+}
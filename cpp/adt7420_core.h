@@ -0,0 +1,252 @@
+/*****************************************************************//**
+ * @file adt7420_core.h
+ *
+ * @brief ADT7420 temperature sensor driver on an i2c core
+ *
+ * Description:
+ *  - device id checked once in init()
+ *  - the ADT7420 keeps its address pointer between transactions;
+ *    the driver tracks it, so repeated reads of the same register
+ *    (e.g., temperature) take a single read transaction
+ *  - 13-bit (1/16 C) or 16-bit (1/128 C) resolution
+ *  - continuous, one-shot, 1-SPS and shutdown modes
+ *  - temperature returned as raw register value and decoded value
+ *  - asynchronous temperature read driven by I2cCore::poll()
+ *  - failed accesses retried (READ_TRIES attempts); bus recovery
+ *    after a time-out; per-device error counters
+ *  - a failed temperature read returns the last good sample and
+ *    sets the stale flag
+ *  - worst case of a blocking access: READ_TRIES x (2 time-outs
+ *    + recovery) of I2cCore, a few ms with the default time-out
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#ifndef _ADT7420_CORE_H_INCLUDED
+#define _ADT7420_CORE_H_INCLUDED
+
+#include "i2c_core.h"
+#include "temperature.h"
+
+/**
+ * per-device error counters
+ */
+struct Adt7420Stats {
+   uint32_t reads;       // # temperature reads (blocking + async)
+   uint32_t nack;        // # accesses not acked
+   uint32_t timeout;     // # accesses timed out
+   uint32_t retries;     // # repeated attempts
+   uint32_t recoveries;  // # bus recovery sequences
+   uint32_t stale;       // # reads answered with the last good sample
+};
+
+/**
+ * ADT7420 driver
+ *  - Nexys4 DDR on-board sensor at i2c address 0x4b
+ *
+ */
+class Adt7420 {
+public:
+   /**
+    * device constants
+    *
+    */
+   enum {
+      DEV_ADDR = 0x4b,    /**< default i2c address */
+      DEV_ID = 0xcb,      /**< content of ID_REG */
+      ONE_SHOT_MS = 240,  /**< one-shot conversion time */
+      MAX_FREQ = 400000,  /**< fastest i2c scl (fast mode) */
+      READ_TRIES = 3      /**< attempts of a failing access */
+   };
+   /**
+    * register map
+    *
+    */
+   enum {
+      TEMP_REG = 0x00,    /**< temperature msb; lsb at 0x01 */
+      STATUS_REG = 0x02,
+      CONFIG_REG = 0x03,
+      ID_REG = 0x0b
+   };
+   /**
+    * config register fields
+    *
+    */
+   enum {
+      RES_16BIT = 0x80,       /**< bit 7: 16-bit resolution */
+      MODE_CONTINUOUS = 0x00, /**< bits 6-5: operation mode */
+      MODE_ONE_SHOT = 0x20,
+      MODE_1SPS = 0x40,
+      MODE_SHUTDOWN = 0x60,
+      MODE_FIELD = 0x60
+   };
+
+   /**
+    * constructor.
+    *
+    * @param i2c_p i2c core the sensor is connected to
+    * @param dev i2c address
+    * @note no bus access until init()
+    */
+   Adt7420(I2cCore *i2c_p, uint8_t dev = DEV_ADDR);
+   ~Adt7420();                  // not used
+
+   /**
+    * read and check the device id; read config register
+    *
+    * @return 0: ok; -1: wrong id; I2cCore::I2C_ERR_xxx
+    */
+   int init();
+
+   /**
+    * device id read by init()
+    */
+   int id();
+
+   /**
+    * set resolution and operation mode
+    *
+    * @param res16 1: 16-bit resolution; 0: 13-bit
+    * @param mode MODE_CONTINUOUS/MODE_ONE_SHOT/MODE_1SPS/MODE_SHUTDOWN
+    * @return 0: ok; I2cCore::I2C_ERR_xxx
+    * @note MODE_ONE_SHOT starts a conversion (ready after ONE_SHOT_MS);
+    *       call again for the next one-shot conversion
+    */
+   int set_config(int res16, int mode);
+
+   /**
+    * 1 if in 16-bit resolution
+    */
+   int res16();
+
+   /**
+    * read the temperature register
+    *
+    * @param raw raw register value (msb:lsb); unchanged on failure
+    * @return 0: ok; I2cCore::I2C_ERR_xxx
+    * @note single read transaction if the address pointer is
+    *       already at TEMP_REG
+    */
+   int read_raw(uint16_t *raw);
+
+   /**
+    * read the temperature in degree Celsius
+    *
+    * @param raw raw register value returned if not 0
+    * @return temperature (C)
+    * @note the last good sample on failure (see stale())
+    */
+   float read(uint16_t *raw = 0);
+
+   /**
+    * read the temperature as a fixed-point value (no float)
+    *
+    * @param raw raw register value returned if not 0
+    * @return temperature
+    * @note the last good sample on failure (see stale())
+    */
+   Temperature read_temp(uint16_t *raw = 0);
+
+   /**
+    * 1 if the latest temperature read failed and the last good
+    * sample is being served
+    */
+   int stale();
+
+   /**
+    * error counters
+    */
+   const Adt7420Stats &stats() {
+      return (st);
+   }
+
+   void clear_stats();
+
+   /**
+    * start an asynchronous temperature read
+    *
+    * @return 0: queued; -1: previous read still pending
+    * @note pointer write and read combined with a repeated start
+    *       when the address pointer is not at TEMP_REG
+    * @note progress by I2cCore::poll(); the blocking methods of
+    *       this driver first complete a pending read
+    */
+   int read_start();
+
+   /**
+    * 1 while an asynchronous read is pending
+    */
+   int read_busy();
+
+   /**
+    * fetch the result of an asynchronous read
+    *
+    * @param raw raw register value; last good sample if the read failed
+    * @return 0: new sample; 1: read failed (stale); -1: no result
+    *         (pending or already fetched)
+    * @note a failed attempt is retried (READ_TRIES attempts in all);
+    *       a time-out queues a bus recovery before the next attempt
+    */
+   int read_result(uint16_t *raw);
+
+   /**
+    * read a register
+    *
+    * @param reg register address
+    * @param data data bytes read
+    * @param num # bytes (auto-increment from reg)
+    * @return 0: ok; I2cCore::I2C_ERR_xxx after READ_TRIES attempts
+    */
+   int read_reg(uint8_t reg, uint8_t *data, int num);
+
+   /**
+    * write a register
+    *
+    * @param reg register address
+    * @param data data byte
+    * @return 0: ok; I2cCore::I2C_ERR_xxx after READ_TRIES attempts
+    */
+   int write_reg(uint8_t reg, uint8_t data);
+
+   /**
+    * convert a raw temperature register to 1/128 C
+    *
+    * @param raw register value
+    * @param res16 1: 16-bit resolution; 0: 13-bit (bits 2-0 are flags)
+    */
+   static int32_t raw_to_q7(uint16_t raw, int res16) {
+      if (res16)
+         return ((int32_t) (int16_t) raw);
+      return ((int32_t) (int16_t) (raw & 0xfff8));
+   }
+
+   /**
+    * convert a raw temperature register to degree Celsius
+    */
+   static float raw_to_c(uint16_t raw, int res16) {
+      return ((float) raw_to_q7(raw, res16) / 128);
+   }
+
+private:
+   I2cCore *i2c;
+   uint8_t dev;
+   uint8_t dev_id;
+   uint8_t config;
+   int ptr;          // device address pointer; -1: unknown
+   I2cXfer xfer;     // asynchronous temperature read
+   uint8_t xfer_reg;
+   uint8_t xfer_data[2];
+   int xfer_new;     // 1: unread result of the async read
+   int xfer_tries;   // # failed attempts of the async read
+   I2cXfer rec_xfer; // asynchronous bus recovery
+   uint16_t last_raw;   // last good temperature sample
+   int stale_flag;
+   Adt7420Stats st;
+   void sync();
+   int fail(int rc);
+   void sample(int rc, uint16_t raw);
+   int set_ptr(uint8_t reg);
+   static void read_done(I2cXfer *x);
+};
+
+#endif  // _ADT7420_CORE_H_INCLUDED
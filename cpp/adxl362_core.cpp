@@ -0,0 +1,107 @@
+/*****************************************************************//**
+ * @file adxl362_core.cpp
+ *
+ * @brief implementation of Adxl362 class
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include "adxl362_core.h"
+
+Adxl362::Adxl362(SpiCore *spi_p, int ss) {
+   spi = spi_p;
+   this->ss = ss;
+   part_axes = 0;
+}
+
+Adxl362::~Adxl362() {
+}
+
+int Adxl362::init(int odr) {
+   spi->set_freq(SPI_FREQ);
+   spi->set_mode(0, 0);
+   write_reg(SOFT_RESET_REG, SOFT_RESET_KEY);
+   sleep_ms(1);   // reset completes within 0.5 ms
+   if (read_reg(DEVID_AD_REG) != DEV_ID_AD || read_reg(PARTID_REG) != PART_ID)
+      return (-1);
+   write_reg(FILTER_CTL_REG, (uint8_t) (odr & 0x07));   // +/-2 g
+   write_reg(FIFO_CONTROL_REG, FIFO_MODE_STREAM);         // x/y/z only
+   write_reg(POWER_CTL_REG, MEASURE_MODE);
+   part_axes = 0;
+   return (0);
+}
+
+void Adxl362::read_reg(uint8_t reg, uint8_t *data, int num) {
+   uint8_t cmd[2] = {CMD_READ_REG, reg};
+
+   spi->read_burst(ss, cmd, 2, data, num);
+}
+
+uint8_t Adxl362::read_reg(uint8_t reg) {
+   uint8_t data;
+
+   read_reg(reg, &data, 1);
+   return (data);
+}
+
+void Adxl362::write_reg(uint8_t reg, uint8_t data) {
+   uint8_t cmd[3] = {CMD_WRITE_REG, reg, data};
+
+   spi->transfer(ss, cmd, 0, 3);
+}
+
+int Adxl362::fifo_entries() {
+   uint8_t d[2];
+
+   read_reg(FIFO_ENTRIES_L_REG, d, 2);
+   return (((d[1] & 0x03) << 8) | d[0]);
+}
+
+void Adxl362::read_xyz(Adxl362Sample *s) {
+   uint8_t d[6];
+
+   read_reg(XDATA_L_REG, d, 6);
+   s->x = (int16_t) (d[0] | (d[1] << 8));
+   s->y = (int16_t) (d[2] | (d[3] << 8));
+   s->z = (int16_t) (d[4] | (d[5] << 8));
+}
+
+int Adxl362::drain(Adxl362Sample *s, int max) {
+   const uint8_t cmd = CMD_READ_FIFO;
+   uint8_t buf[2 * DRAIN_BURST];
+   int left, burst, num = 0;
+
+   // entries of the sets still to come (and of the one in progress)
+   left = fifo_entries();
+   if (left > 3 * max)
+      left = 3 * max;
+   while (left > 0 && num < max) {
+      burst = (left > DRAIN_BURST) ? DRAIN_BURST : left;
+      spi->read_burst(ss, &cmd, 1, buf, 2 * burst);
+      left -= burst;
+      for (int i = 0; i < burst; i++) {
+         uint16_t e = (uint16_t) (buf[2 * i] | (buf[2 * i + 1] << 8));
+         int16_t v = entry_data(e);
+         switch (entry_axis(e)) {
+         case 0:
+            // x starts a set; an incomplete one is dropped
+            part.x = v;
+            part_axes = 0x01;
+            break;
+         case 1:
+            part.y = v;
+            part_axes |= 0x02;
+            break;
+         case 2:
+            part.z = v;
+            if ((part_axes | 0x04) == 0x07 && num < max)
+               s[num++] = part;
+            part_axes = 0;
+            break;
+         default:
+            break;   // temperature entry (not enabled)
+         }
+      }
+   }
+   return (num);
+}
@@ -0,0 +1,175 @@
+/*****************************************************************//**
+ * @file adxl362_core.h
+ *
+ * @brief ADXL362 accelerometer driver on an spi core
+ *
+ * Description:
+ *  - spi mode 0, up to 8M Hz sclk (5M Hz used)
+ *  - register access: one burst per command (write 0x0a, read 0x0b;
+ *    address auto-increments)
+ *  - samples collected in the sensor's FIFO (stream mode, x/y/z
+ *    sets at the selected output data rate) and drained in bursts:
+ *    one FIFO read command per DRAIN_BURST entries instead of
+ *    per-register reads
+ *  - FIFO entry: 16 bits, little endian; bits 15-14 axis
+ *    (0 x, 1 y, 2 z, 3 temperature), bits 13-0 signed data;
+ *    a set split across two drains is completed on the next one
+ *  - +/-2 g range: 1 mg per LSB
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#ifndef _ADXL362_CORE_H_INCLUDED
+#define _ADXL362_CORE_H_INCLUDED
+
+#include "spi_core.h"
+
+/**
+ * acceleration sample (mg)
+ */
+struct Adxl362Sample {
+   int16_t x;
+   int16_t y;
+   int16_t z;
+};
+
+/**
+ * ADXL362 driver
+ *  - Nexys4 DDR on-board sensor at slave select 0 of the spi core
+ *
+ */
+class Adxl362 {
+public:
+   /**
+    * device constants
+    *
+    */
+   enum {
+      DEV_ID_AD = 0xad,   /**< content of DEVID_AD_REG */
+      PART_ID = 0xf2,     /**< content of PARTID_REG */
+      SPI_FREQ = 5000000, /**< sclk frequency */
+      FIFO_ENTRIES = 512, /**< FIFO depth (16-bit entries) */
+      DRAIN_BURST = 48    /**< max # entries per FIFO read burst */
+   };
+   /**
+    * spi commands
+    *
+    */
+   enum {
+      CMD_WRITE_REG = 0x0a,
+      CMD_READ_REG = 0x0b,
+      CMD_READ_FIFO = 0x0d
+   };
+   /**
+    * register map
+    *
+    */
+   enum {
+      DEVID_AD_REG = 0x00,
+      PARTID_REG = 0x02,
+      XDATA_L_REG = 0x0e,       /**< x, y, z: 16-bit, little endian */
+      FIFO_ENTRIES_L_REG = 0x0c,
+      SOFT_RESET_REG = 0x1f,
+      FIFO_CONTROL_REG = 0x28,
+      FIFO_SAMPLES_REG = 0x29,
+      FILTER_CTL_REG = 0x2c,
+      POWER_CTL_REG = 0x2d
+   };
+   /**
+    * register fields
+    *
+    */
+   enum {
+      SOFT_RESET_KEY = 0x52,    /**< SOFT_RESET_REG */
+      FIFO_MODE_STREAM = 0x02,  /**< FIFO_CONTROL_REG */
+      MEASURE_MODE = 0x02,      /**< POWER_CTL_REG */
+      ODR_12HZ = 0x00,          /**< FILTER_CTL_REG bits 2-0 */
+      ODR_25HZ = 0x01,
+      ODR_50HZ = 0x02,
+      ODR_100HZ = 0x03,
+      ODR_200HZ = 0x04,
+      ODR_400HZ = 0x05
+   };
+
+   /**
+    * constructor.
+    *
+    * @param spi_p spi core the sensor is connected to
+    * @param ss slave select #
+    * @note no bus access until init()
+    */
+   Adxl362(SpiCore *spi_p, int ss = 0);
+   ~Adxl362();                  // not used
+
+   /**
+    * reset the sensor, check the id, start measurement with the
+    * FIFO in stream mode
+    *
+    * @param odr output data rate (ODR_xxx)
+    * @return 0: ok; -1: no ADXL362 found
+    */
+   int init(int odr = ODR_100HZ);
+
+   /**
+    * read registers
+    *
+    * @param reg first register
+    * @param data data bytes read
+    * @param num # bytes
+    */
+   void read_reg(uint8_t reg, uint8_t *data, int num);
+
+   /**
+    * read a single register
+    */
+   uint8_t read_reg(uint8_t reg);
+
+   /**
+    * write a register
+    */
+   void write_reg(uint8_t reg, uint8_t data);
+
+   /**
+    * # entries in the FIFO (3 per sample)
+    */
+   int fifo_entries();
+
+   /**
+    * read the current acceleration (data registers, one burst)
+    *
+    * @param s sample
+    */
+   void read_xyz(Adxl362Sample *s);
+
+   /**
+    * drain the FIFO
+    *
+    * @param s samples
+    * @param max max # samples (bounds the time spent)
+    * @return # samples stored in s
+    * @note entries left in the FIFO are read by the next call
+    */
+   int drain(Adxl362Sample *s, int max);
+
+   /**
+    * sign-extended data of a FIFO entry
+    */
+   static int16_t entry_data(uint16_t e) {
+      return ((int16_t) (e << 2) >> 2);
+   }
+
+   /**
+    * axis of a FIFO entry (0 x, 1 y, 2 z, 3 temperature)
+    */
+   static int entry_axis(uint16_t e) {
+      return (e >> 14);
+   }
+
+private:
+   SpiCore *spi;
+   int ss;
+   Adxl362Sample part;   // set being assembled from FIFO entries
+   int part_axes;        // axes of part received (bit 0 x, 1 y, 2 z)
+};
+
+#endif  // _ADXL362_CORE_H_INCLUDED
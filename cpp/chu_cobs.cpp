@@ -0,0 +1,99 @@
+/*****************************************************************//**
+ * @file chu_cobs.cpp
+ *
+ * @brief implementation of COBS framing and CRC-16
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include "chu_cobs.h"
+
+// crc of a nibble (poly 0x1021)
+static const uint16_t CRC16_NIB[16] =
+   {0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
+    0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad, 0xe1ce, 0xf1ef};
+
+uint16_t crc16_ccitt(uint16_t crc, const uint8_t *data, int n) {
+   int i;
+
+   for (i = 0; i < n; i++) {
+      crc = (uint16_t) ((crc << 4) ^ CRC16_NIB[(crc >> 12) ^ (data[i] >> 4)]);
+      crc = (uint16_t) ((crc << 4) ^ CRC16_NIB[(crc >> 12) ^ (data[i] & 0x0f)]);
+   }
+   return (crc);
+}
+
+int cobs_encode(const uint8_t *src, int n, uint8_t *dst) {
+   int code_pos = 0;   // position of current code byte
+   int out = 1;
+   uint8_t code = 1;
+   int i;
+
+   for (i = 0; i < n; i++) {
+      if (src[i] == 0) {
+         dst[code_pos] = code;
+         code_pos = out++;
+         code = 1;
+      } else {
+         dst[out++] = src[i];
+         code++;
+         if (code == 0xff) {   // full 254-byte block
+            dst[code_pos] = code;
+            code_pos = out++;
+            code = 1;
+         }
+      }
+   }
+   dst[code_pos] = code;
+   return (out);
+}
+
+int cobs_decode(const uint8_t *src, int n, uint8_t *dst) {
+   int in = 0, out = 0;
+   uint8_t code;
+   int i;
+
+   while (in < n) {
+      code = src[in++];
+      if (code == 0 || in + code - 1 > n)
+         return (-1);
+      for (i = 1; i < code; i++) {
+         if (src[in] == 0)
+            return (-1);
+         dst[out++] = src[in++];
+      }
+      // a short block marks a zero, except at the end
+      if (code != 0xff && in < n)
+         dst[out++] = 0;
+   }
+   return (out);
+}
+
+int cobs_frame(const uint8_t *payload, int n, uint8_t *dst) {
+   uint8_t tmp[COBS_MAX_DATA];
+   uint16_t crc;
+   int i, len;
+
+   if (n > COBS_MAX_DATA - 2)
+      return (-1);
+   for (i = 0; i < n; i++)
+      tmp[i] = payload[i];
+   crc = crc16_ccitt(CRC16_INIT, payload, n);
+   tmp[n] = (uint8_t) (crc >> 8);
+   tmp[n + 1] = (uint8_t) crc;
+   len = cobs_encode(tmp, n + 2, dst);
+   dst[len] = 0;
+   return (len + 1);
+}
+
+int cobs_unframe(const uint8_t *src, int n, uint8_t *dst) {
+   int len;
+
+   len = cobs_decode(src, n, dst);
+   if (len < 2)
+      return (-1);
+   // crc over payload plus its own crc bytes is 0
+   if (crc16_ccitt(CRC16_INIT, dst, len) != 0)
+      return (-2);
+   return (len - 2);
+}
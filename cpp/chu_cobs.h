@@ -0,0 +1,83 @@
+/*****************************************************************//**
+ * @file chu_cobs.h
+ *
+ * @brief COBS framing and CRC-16 for binary serial streams
+ *
+ * Description:
+ *  - COBS (consistent overhead byte stuffing) removes all 0x00
+ *    bytes from a frame, so 0x00 can delimit frames; overhead is
+ *    1 byte per 254 data bytes
+ *  - CRC-16/CCITT-FALSE (poly 0x1021, init 0xffff), nibble table
+ *  - frame on the wire: COBS(payload, crc_hi, crc_lo), 0x00
+ *  - plain C; also compiled into the host decoder
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#ifndef _CHU_COBS_H_INCLUDED
+#define _CHU_COBS_H_INCLUDED
+
+#include <inttypes.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define COBS_MAX_DATA 254   // max # bytes encoded by one cobs_encode()
+#define CRC16_INIT 0xffff
+
+/**
+ * # bytes of COBS output for n bytes of data (without delimiter)
+ */
+#define COBS_ENC_LEN(n) ((n) + 1 + (n) / 254)
+
+/**
+ * update a CRC-16/CCITT-FALSE
+ * @param crc current crc (CRC16_INIT for a new message)
+ * @param data data bytes
+ * @param n # bytes
+ * @return updated crc
+ */
+uint16_t crc16_ccitt(uint16_t crc, const uint8_t *data, int n);
+
+/**
+ * COBS-encode a block
+ * @param src data
+ * @param n # data bytes (up to COBS_MAX_DATA)
+ * @param dst output buffer of at least COBS_ENC_LEN(n) bytes
+ * @return # encoded bytes (no 0x00 among them)
+ */
+int cobs_encode(const uint8_t *src, int n, uint8_t *dst);
+
+/**
+ * COBS-decode a block (delimiter excluded)
+ * @param src encoded bytes
+ * @param n # encoded bytes
+ * @param dst output buffer of at least n bytes (may equal src)
+ * @return # decoded bytes; -1 if the block is malformed
+ */
+int cobs_decode(const uint8_t *src, int n, uint8_t *dst);
+
+/**
+ * build a complete frame: COBS(payload + crc16) + 0x00
+ * @param payload payload bytes
+ * @param n # payload bytes (up to COBS_MAX_DATA - 2)
+ * @param dst output buffer of at least COBS_ENC_LEN(n + 2) + 1 bytes
+ * @return # frame bytes; -1 if payload too long
+ */
+int cobs_frame(const uint8_t *payload, int n, uint8_t *dst);
+
+/**
+ * check and strip a received frame (delimiter excluded)
+ * @param src encoded bytes
+ * @param n # encoded bytes
+ * @param dst output buffer of at least n bytes (may equal src)
+ * @return # payload bytes; -1 if malformed; -2 on crc error
+ */
+int cobs_unframe(const uint8_t *src, int n, uint8_t *dst);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif  // _CHU_COBS_H_INCLUDED
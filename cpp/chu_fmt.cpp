@@ -0,0 +1,291 @@
+/*****************************************************************//**
+ * @file chu_fmt.cpp
+ *
+ * @brief implementation of integer/fixed-point formatting
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include "chu_fmt.h"
+#include "timer_core.h"    // ConstDiv
+
+static const char DIGIT_PAIR[] =
+   "00010203040506070809"
+   "10111213141516171819"
+   "20212223242526272829"
+   "30313233343536373839"
+   "40414243444546474849"
+   "50515253545556575859"
+   "60616263646566676869"
+   "70717273747576777879"
+   "80818283848586878889"
+   "90919293949596979899";
+
+static const uint32_t POW10[FMT_DIGIT_MAX + 1] =
+   {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000,
+    1000000000};
+
+/**********************************************************************
+ * output sink: bounded buffer, always null-terminated
+ *********************************************************************/
+typedef struct {
+   char *buf;
+   int size;
+   int n;
+} fmt_sink_t;
+
+static inline void put(fmt_sink_t *o, char ch) {
+   if (o->n < o->size - 1)
+      o->buf[o->n++] = ch;
+}
+
+// place [sign][body] in a field of width chars
+static void field(fmt_sink_t *o, char sign, const char *body, int len,
+      int width, int flags) {
+   int pad, i;
+
+   if (width > FMT_WIDTH_MAX)
+      width = FMT_WIDTH_MAX;
+   pad = width - len - (sign ? 1 : 0);
+   if (!(flags & (FMT_LEFT | FMT_ZERO)))
+      for (i = 0; i < pad; i++)
+         put(o, ' ');
+   if (sign)
+      put(o, sign);
+   if ((flags & FMT_ZERO) && !(flags & FMT_LEFT))
+      for (i = 0; i < pad; i++)
+         put(o, '0');
+   for (i = 0; i < len; i++)
+      put(o, body[i]);
+   if (flags & FMT_LEFT)
+      for (i = 0; i < pad; i++)
+         put(o, ' ');
+}
+
+// write decimal digits of u backwards, ending before end; return start
+static char *dec_rev(char *end, uint32_t u) {
+   const char *p;
+   uint32_t q;
+
+   while (u >= 100) {
+      q = ConstDiv<100>::div32(u);
+      p = &DIGIT_PAIR[2 * (u - q * 100)];
+      *--end = p[1];
+      *--end = p[0];
+      u = q;
+   }
+   if (u >= 10) {
+      p = &DIGIT_PAIR[2 * u];
+      *--end = p[1];
+      *--end = p[0];
+   } else {
+      *--end = (char) ('0' + u);
+   }
+   return (end);
+}
+
+static char sign_of(int neg, int flags) {
+   if (neg)
+      return ('-');
+   return ((flags & FMT_PLUS) ? '+' : 0);
+}
+
+/**********************************************************************
+ * conversions into a sink
+ *********************************************************************/
+static void out_udec(fmt_sink_t *o, char sign, uint32_t u, int width,
+      int flags) {
+   char tmp[12];
+   char *s;
+
+   s = dec_rev(tmp + sizeof(tmp), u);
+   field(o, sign, s, (int) (tmp + sizeof(tmp) - s), width, flags);
+}
+
+static void out_hex(fmt_sink_t *o, uint32_t u, int width, int flags) {
+   const char *hex = (flags & FMT_UPPER) ? "0123456789ABCDEF"
+                                         : "0123456789abcdef";
+   char tmp[8];
+   char *s = tmp + sizeof(tmp);
+
+   do {
+      *--s = hex[u & 0x0f];
+      u = u >> 4;
+   } while (u);
+   field(o, 0, s, (int) (tmp + sizeof(tmp) - s), width, flags);
+}
+
+static void out_fix(fmt_sink_t *o, int32_t x, int qbits, int digits,
+      int width, int flags) {
+   char tmp[24];
+   char *end = tmp + sizeof(tmp);
+   char *s = end;
+   uint32_t ax, ip, frac, fd;
+
+   if (qbits < 0)
+      qbits = 0;
+   if (qbits > 31)
+      qbits = 31;
+   if (digits < 0)
+      digits = 0;
+   if (digits > FMT_DIGIT_MAX)
+      digits = FMT_DIGIT_MAX;
+   ax = (x < 0) ? 0u - (uint32_t) x : (uint32_t) x;
+   ip = ax >> qbits;
+   frac = ax & ((1UL << qbits) - 1);
+   if (digits > 0) {
+      // fraction digits truncated, as UartCore::dbl2str()
+      fd = (uint32_t) (((uint64_t) frac * POW10[digits]) >> qbits);
+      s = dec_rev(end, fd);
+      while (end - s < digits)
+         *--s = '0';
+      *--s = '.';
+   }
+   s = dec_rev(s, ip);
+   field(o, sign_of(x < 0, flags), s, (int) (end - s), width, flags);
+}
+
+/**********************************************************************
+ * single-number formatting
+ *********************************************************************/
+int fmt_dec(char *buf, int32_t n, int width, int flags) {
+   fmt_sink_t o = {buf, FMT_NUM_LEN, 0};
+   uint32_t u = (n < 0) ? 0u - (uint32_t) n : (uint32_t) n;
+
+   out_udec(&o, sign_of(n < 0, flags), u, width, flags);
+   buf[o.n] = '\0';
+   return (o.n);
+}
+
+int fmt_udec(char *buf, uint32_t u, int width, int flags) {
+   fmt_sink_t o = {buf, FMT_NUM_LEN, 0};
+
+   out_udec(&o, 0, u, width, flags);
+   buf[o.n] = '\0';
+   return (o.n);
+}
+
+int fmt_hex(char *buf, uint32_t u, int width, int flags) {
+   fmt_sink_t o = {buf, FMT_NUM_LEN, 0};
+
+   out_hex(&o, u, width, flags);
+   buf[o.n] = '\0';
+   return (o.n);
+}
+
+int fmt_fix(char *buf, int32_t x, int qbits, int digits, int width,
+      int flags) {
+   fmt_sink_t o = {buf, FMT_NUM_LEN, 0};
+
+   out_fix(&o, x, qbits, digits, width, flags);
+   buf[o.n] = '\0';
+   return (o.n);
+}
+
+/**********************************************************************
+ * printf-style front end
+ *********************************************************************/
+// parse a decimal number; advance *p
+static int parse_num(const char **p) {
+   int n = 0;
+
+   while (**p >= '0' && **p <= '9') {
+      if (n < 1000)
+         n = n * 10 + (**p - '0');
+      (*p)++;
+   }
+   return (n);
+}
+
+int fmt_vformat(char *buf, int size, const char *fmt, va_list ap) {
+   fmt_sink_t o = {buf, size, 0};
+   const char *str;
+   int flags, width, prec, len, q;
+   int32_t n;
+   char ch;
+
+   if (size <= 0)
+      return (0);
+   while (*fmt) {
+      if (*fmt != '%') {
+         put(&o, *fmt++);
+         continue;
+      }
+      fmt++;
+      // flags, width, precision
+      flags = 0;
+      for (;; fmt++) {
+         if (*fmt == '-')
+            flags |= FMT_LEFT;
+         else if (*fmt == '0')
+            flags |= FMT_ZERO;
+         else if (*fmt == '+')
+            flags |= FMT_PLUS;
+         else
+            break;
+      }
+      width = parse_num(&fmt);
+      prec = -1;
+      if (*fmt == '.') {
+         fmt++;
+         prec = parse_num(&fmt);
+      }
+      // conversion
+      switch (*fmt) {
+      case 'd':
+      case 'i':
+         n = (int32_t) va_arg(ap, int);
+         out_udec(&o, sign_of(n < 0, flags),
+               (n < 0) ? 0u - (uint32_t) n : (uint32_t) n, width, flags);
+         break;
+      case 'u':
+         out_udec(&o, 0, (uint32_t) va_arg(ap, unsigned), width, flags);
+         break;
+      case 'X':
+         flags |= FMT_UPPER;
+         out_hex(&o, (uint32_t) va_arg(ap, unsigned), width, flags);
+         break;
+      case 'x':
+         out_hex(&o, (uint32_t) va_arg(ap, unsigned), width, flags);
+         break;
+      case 'q':
+         fmt++;
+         q = parse_num(&fmt);
+         fmt--;
+         out_fix(&o, (int32_t) va_arg(ap, int), q, (prec < 0) ? 3 : prec,
+               width, flags);
+         break;
+      case 'c':
+         ch = (char) va_arg(ap, int);
+         field(&o, 0, &ch, 1, width, flags & FMT_LEFT);
+         break;
+      case 's':
+         str = va_arg(ap, const char *);
+         if (!str)
+            str = "(null)";
+         for (len = 0; str[len] && (prec < 0 || len < prec); len++) {
+         }
+         field(&o, 0, str, len, width, flags & FMT_LEFT);
+         break;
+      case '\0':
+         fmt--;   // incomplete spec at end of string
+         break;
+      default:    // '%' and unknown types printed as is
+         put(&o, *fmt);
+         break;
+      }
+      fmt++;
+   }
+   buf[o.n] = '\0';
+   return (o.n);
+}
+
+int fmt_format(char *buf, int size, const char *fmt, ...) {
+   va_list ap;
+   int n;
+
+   va_start(ap, fmt);
+   n = fmt_vformat(buf, size, fmt, ap);
+   va_end(ap);
+   return (n);
+}
@@ -0,0 +1,115 @@
+/*****************************************************************//**
+ * @file chu_fmt.h
+ *
+ * @brief integer/fixed-point to text formatting without libc
+ *
+ * Description:
+ *  - decimal conversion two digits at a time from a digit-pair
+ *    table; divide by 100 done by ConstDiv (no divide instruction)
+ *  - field width, blank/zero padding, left alignment and sign
+ *  - fixed-point numbers: Q format with qbits fraction bits,
+ *    printed with a given # of decimal digits (truncated, as
+ *    UartCore::disp(double))
+ *  - output written into a caller buffer in one pass; the result
+ *    is null-terminated and its length returned
+ *  - fmt_format()/fmt_vformat(): printf-style front end
+ *
+ * Conversion spec: %[flags][width][.prec]type
+ *  - flags: '-' left align; '0' zero padding; '+' force sign
+ *  - types:
+ *      d, i  signed decimal
+ *      u     unsigned decimal
+ *      x, X  hexadecimal
+ *      c     char
+ *      s     string (prec: max # chars)
+ *      qN    signed fixed-point int32_t with N fraction bits
+ *            (prec: # fraction digits, default 3), e.g., %q4, %.2q7
+ *      %     '%'
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#ifndef _CHU_FMT_H_INCLUDED
+#define _CHU_FMT_H_INCLUDED
+
+#include <inttypes.h>
+#include <stdarg.h>
+
+/**
+ * format flags
+ */
+enum {
+   FMT_LEFT = 0x01,   /**< left align in field */
+   FMT_ZERO = 0x02,   /**< pad with '0' instead of ' ' */
+   FMT_PLUS = 0x04,   /**< '+' for non-negative number */
+   FMT_UPPER = 0x08   /**< upper-case hex digits */
+};
+
+#define FMT_WIDTH_MAX 32   // max field width
+#define FMT_DIGIT_MAX 9    // max # fraction digits of fixed-point
+#define FMT_NUM_LEN 48     // buffer size enough for any single number
+
+/**
+ * format a signed decimal number
+ * @param buf output buffer (at least FMT_NUM_LEN chars)
+ * @param n number
+ * @param width min field width (up to FMT_WIDTH_MAX)
+ * @param flags FMT_LEFT/FMT_ZERO/FMT_PLUS
+ * @return # chars written (excluding null)
+ */
+int fmt_dec(char *buf, int32_t n, int width, int flags);
+
+/**
+ * format an unsigned decimal number
+ * @param buf output buffer (at least FMT_NUM_LEN chars)
+ * @param u number
+ * @param width min field width
+ * @param flags FMT_LEFT/FMT_ZERO
+ * @return # chars written (excluding null)
+ */
+int fmt_udec(char *buf, uint32_t u, int width, int flags);
+
+/**
+ * format a hexadecimal number
+ * @param buf output buffer (at least FMT_NUM_LEN chars)
+ * @param u number
+ * @param width min field width
+ * @param flags FMT_LEFT/FMT_ZERO/FMT_UPPER
+ * @return # chars written (excluding null)
+ */
+int fmt_hex(char *buf, uint32_t u, int width, int flags);
+
+/**
+ * format a signed fixed-point number
+ * @param buf output buffer (at least FMT_NUM_LEN chars)
+ * @param x fixed-point number (value = x / 2^qbits)
+ * @param qbits # fraction bits (0 to 31)
+ * @param digits # decimal fraction digits (up to FMT_DIGIT_MAX);
+ *        0 omits the point
+ * @param width min field width
+ * @param flags FMT_LEFT/FMT_ZERO/FMT_PLUS
+ * @return # chars written (excluding null)
+ */
+int fmt_fix(char *buf, int32_t x, int qbits, int digits, int width,
+      int flags);
+
+/**
+ * printf-style formatting
+ * @param buf output buffer
+ * @param size buffer size (output truncated to size-1 chars)
+ * @param fmt format string
+ * @param ap arguments
+ * @return # chars written (excluding null)
+ */
+int fmt_vformat(char *buf, int size, const char *fmt, va_list ap);
+
+/**
+ * printf-style formatting
+ * @param buf output buffer
+ * @param size buffer size (output truncated to size-1 chars)
+ * @param fmt format string
+ * @return # chars written (excluding null)
+ */
+int fmt_format(char *buf, int size, const char *fmt, ...);
+
+#endif  // _CHU_FMT_H_INCLUDED
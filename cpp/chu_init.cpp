@@ -23,6 +23,7 @@
 
 TimerCore _sys_timer(get_slot_addr(BRIDGE_BASE, TIMER_SLOT));
 UartCore uart(get_slot_addr(BRIDGE_BASE, UART_SLOT));
+TimerWheel sys_wheel(&_sys_timer);
 
 // current system time in microsecond
 unsigned long now_us() {
@@ -31,7 +32,22 @@ unsigned long now_us() {
 
 // current system time in ms
 unsigned long now_ms() {
-   return ((unsigned long) _sys_timer.read_time() / 1000);
+   return ((unsigned long) ticks_to_ms(_sys_timer.read_tick()));
+}
+
+// current system time in clock ticks
+uint64_t now_tick() {
+   return (_sys_timer.read_tick());
+}
+
+// lower 32 bits of current system time in clock ticks
+uint32_t now_tick32() {
+   return (_sys_timer.read_tick32());
+}
+
+// ticks elapsed since start (modulo 2^32)
+uint32_t elapsed_ticks(uint32_t start) {
+   return (_sys_timer.read_tick32() - start);
 }
 
 // idle for t microseconds
@@ -41,7 +57,7 @@ void sleep_us(unsigned long int t) {
 
 // idle for t ms
 void sleep_ms(unsigned long int t) {
-   _sys_timer.sleep(uint64_t(1000 * t));
+   _sys_timer.sleep(uint64_t(1000) * t);
 }
 
 // debug asserted
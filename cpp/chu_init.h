@@ -13,6 +13,8 @@
  *  - "uart" is visible by external code
  *  - "uart" can be used as the default char stream port
  *  - timer core and uart core must be instantiated in slots 0 and 1
+ *  - create a "sys_wheel" instance of software timers on _sys_timer;
+ *    sys_wheel.advance() must be called from the main loop
  *  - debug() macro print a message when _DEBUG defined
  *
  *
@@ -34,10 +36,14 @@
 #include "chu_io_map.h"
 #include "timer_core.h"
 #include "uart_core.h"
+#include "timer_wheel.h"
 
 //  make uart visible by other code
 extern UartCore uart;
 
+//  software timers on the system timer
+extern TimerWheel sys_wheel;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -55,6 +61,24 @@ unsigned long now_us();
  */
 unsigned long now_ms();
 
+/**
+ * Current system "up time" in system clock ticks.
+ */
+uint64_t now_tick();
+
+/**
+ * lower 32 bits of system "up time" in ticks (single register read).
+ * @note wraps around every 2^32 ticks (42.9 s at 100 MHz)
+ */
+uint32_t now_tick32();
+
+/**
+ * # ticks elapsed since a now_tick32() time stamp.
+ * @param start time stamp from now_tick32()
+ * @note wrap-safe for intervals shorter than TICK32_SPAN
+ */
+uint32_t elapsed_ticks(uint32_t start);
+
 /**
  * idle for t microsecond.
  * @param t idle time
@@ -91,17 +115,84 @@ void debug_off();
  * @param n1 first number
  * @param n2 first number
  * @note substitute debug() when _DEBUG is defined
+ * @note debug() is a no-op otherwise; e.g., PwmCore::set_duty(double)
+ *       prints its duty only in a _DEBUG build
  */
 void debug_on(const char *str, int n1, int n2);
 
 #ifndef _DEBUG
 #define debug(str, n1, n2) debug_off()
-#endif // not _DEBUG#ifdef _DEBUG
+#endif // not _DEBUG
+
+#ifdef _DEBUG
 #define debug(str, n1, n2) debug_on((str), (n1), (n2))
-#endif // not _DEBUG#ifdef __cplusplus
+#endif // not _DEBUG
+
+#ifdef __cplusplus
 } // extern "C"
 #endif
 
+/**********************************************************************
+ * Deadline: time-out check without division
+ *  - expiry time kept in ticks; expired() compares tick counts
+ *  - timeout shorter than TICK32_SPAN: 32-bit counter read and
+ *    wrap-safe signed comparison (expired() must be polled at
+ *    least once every TICK32_SPAN ticks)
+ *  - longer timeout: 64-bit counter read and comparison
+ *  - a default-constructed deadline is expired
+ *********************************************************************/
+class Deadline {
+public:
+   Deadline() : end(0), wide(0), armed(0) {}
+
+   /**
+    * start the timeout from now
+    * @param ticks timeout in system clock ticks
+    */
+   void set_ticks(uint64_t ticks) {
+      wide = (ticks >= TICK32_SPAN);
+      end = (wide ? now_tick() : now_tick32()) + ticks;
+      armed = 1;
+   }
+
+   void set_us(uint64_t us) {
+      set_ticks(us_to_ticks(us));
+   }
+
+   void set_ms(uint32_t ms) {
+      set_ticks(ms_to_ticks(ms));
+   }
+
+   /**
+    * move the expiry time by a period from the previous expiry
+    * @param ticks period in ticks (shorter than TICK32_SPAN)
+    * @note drift-free periodic timing
+    */
+   void advance_ticks(uint32_t ticks) {
+      end = end + ticks;
+      armed = 1;
+   }
+
+   /**
+    * check whether the timeout has passed
+    * @return 1 if expired
+    */
+   int expired() {
+      if (!armed)
+         return (1);
+      if (wide)
+         armed = (now_tick() < end);
+      else
+         armed = ((int32_t) (now_tick32() - (uint32_t) end) < 0);
+      return (!armed);
+   }
+
+private:
+   uint64_t end;   // expiry time (only lower 32 bits used if !wide)
+   uint8_t wide;
+   uint8_t armed;
+};
+
 /**********************************************************************
  * low-level bit-manipulation macros
  * @param n bit position
@@ -113,4 +204,4 @@ void debug_on(const char *str, int n1, int n2);
 #define bit_write(data, n, bitvalue) (bitvalue ? bit_set((data), n) : bit_clear((data), n))
 #define bit(n) (1UL << (n))
 
-#endif  // _CHU_INIT_H_INCLUDED
\ No newline at end of file
+#endif  // _CHU_INIT_H_INCLUDED
@@ -22,6 +22,11 @@ extern "C" {
  *  - must bypass data cache for I/O access
  *  - may be replaced with vendor provided macros
  *   (if _VENDOR_IO_ACCESS_USED is defined)
+ *  - the host-side emulated bus (host/chu_io_emu.h) is used
+ *    as the "vendor" access for builds on a workstation
+ *  - io_read_raw()/io_write_raw() perform the actual access;
+ *    io_read()/io_write() add access counting when _IO_STATS
+ *    is defined (see chu_io_stats.h)
  *********************************************************************/
 #ifndef _VENDOR_IO_ACCESS_USED
 
@@ -32,7 +37,7 @@ extern "C" {
  * @return 32-bit data of the register
  * @note macro calculates the byte address of the register and then read
  */
-#define io_read(base_addr, offset) \
+#define io_read_raw(base_addr, offset) \
    (*(volatile uint32_t *)((base_addr) + 4*(offset)))
 
 /**
@@ -41,10 +46,44 @@ extern "C" {
  * @param offset register word offset
  * @param data 32-bit data
  */
-#define io_write(base_addr, offset, data) \
+#define io_write_raw(base_addr, offset, data) \
    (*(volatile uint32_t *)((base_addr) + 4*(offset)) = (data))
 
+#else   // _VENDOR_IO_ACCESS_USED
+
+#include "chu_io_emu.h"
+
+#define io_read_raw(base_addr, offset) \
+   emu_io_read((uint32_t)(base_addr), (uint32_t)(offset))
+
+#define io_write_raw(base_addr, offset, data) \
+   emu_io_write((uint32_t)(base_addr), (uint32_t)(offset), (uint32_t)(data))
+
 #endif  // _VENDOR_IO_ACCESS_USED
+
+/**********************************************************************
+ * io access used by drivers
+ *  - _IO_STATS must be defined for the whole build (compiler flag)
+ *  - without _IO_STATS the macros map directly to the raw access
+ *********************************************************************/
+#ifdef _IO_STATS
+
+#include "chu_io_stats.h"
+
+#define io_read(base_addr, offset) \
+   io_stats_read((uint32_t)(base_addr), (uint32_t)(offset))
+
+#define io_write(base_addr, offset, data) \
+   io_stats_write((uint32_t)(base_addr), (uint32_t)(offset), (uint32_t)(data))
+
+#else   // _IO_STATS
+
+#define io_read(base_addr, offset) io_read_raw(base_addr, offset)
+
+#define io_write(base_addr, offset, data) io_write_raw(base_addr, offset, data)
+
+#endif  // _IO_STATS
+
 /**
  * calculate base address of a memory mapped io slot.
  * @param base base-address of FPro system.
@@ -65,6 +104,18 @@ extern "C" {
  */
 #define get_sprite_addr(base, sprite) \
 		((uint32_t)((base) + 0x00800000 + (sprite)*16384*4))
+
+/**
+ * declare a statically initialized (no constructor at boot) object.
+ * @note expands to "constinit" when the compiler supports it (C++20);
+ *       a constexpr constructor gives constant initialization anyway
+ */
+#if defined(__cpp_constinit)
+#define CHU_CONSTINIT constinit
+#else
+#define CHU_CONSTINIT
+#endif
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
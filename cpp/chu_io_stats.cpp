@@ -0,0 +1,148 @@
+/*****************************************************************//**
+ * @file chu_io_stats.cpp
+ *
+ * @brief implementation of io access counters and tracer
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include "chu_init.h"
+
+#ifdef _IO_STATS
+
+// system timer defined in chu_init.cpp
+extern TimerCore _sys_timer;
+
+uint32_t io_stats_rd[IO_STATS_SLOTS + 1][IO_STATS_REGS];
+uint32_t io_stats_wr[IO_STATS_SLOTS + 1][IO_STATS_REGS];
+int io_stats_busy = 0;
+
+static const char *const SLOT_NAME[IO_STATS_SLOTS + 1] =
+   {"timer", "uart", "led", "sw", "user", "xadc", "pwm", "btn",
+    "sseg", "spi", "i2c", "ps2", "ddfs", "adsr", "other"};
+
+/**********************************************************************
+ * trace ring
+ *********************************************************************/
+#ifdef _IO_TRACE
+typedef struct {
+   uint32_t tick;     // lower 32 bits of system timer
+   uint32_t data;     // data read/written
+   uint8_t slot;
+   uint8_t reg;
+   uint8_t wr;
+} io_trace_t;
+
+static io_trace_t trace_buf[IO_TRACE_DEPTH];
+static uint32_t trace_num = 0;   // # records ever written
+static int trace_on = 1;
+
+void io_trace_record(int slot, int reg, int wr, uint32_t data) {
+   io_trace_t *t;
+
+   if (!trace_on)
+      return;
+   io_stats_busy = 1;
+   t = &trace_buf[trace_num & (IO_TRACE_DEPTH - 1)];
+   t->tick = _sys_timer.read_tick32();
+   t->data = data;
+   t->slot = (uint8_t) slot;
+   t->reg = (uint8_t) reg;
+   t->wr = (uint8_t) wr;
+   trace_num++;
+   io_stats_busy = 0;
+}
+#endif  // _IO_TRACE
+
+void io_trace_enable(int on) {
+#ifdef _IO_TRACE
+   trace_on = on;
+#else
+   (void) on;
+#endif
+}
+
+void io_trace_dump() {
+#ifdef _IO_TRACE
+   uint32_t i, first;
+   io_trace_t *t;
+
+   io_stats_busy = 1;
+   first = (trace_num > IO_TRACE_DEPTH) ? trace_num - IO_TRACE_DEPTH : 0;
+   uart.disp("io trace (tick slot reg r/w data):\n\r");
+   for (i = first; i < trace_num; i++) {
+      t = &trace_buf[i & (IO_TRACE_DEPTH - 1)];
+      uart.disp((int) t->tick, 16, 8);
+      uart.disp(" ");
+      uart.disp(SLOT_NAME[t->slot]);
+      uart.disp(" ");
+      uart.disp((int) t->reg, 10, 2);
+      uart.disp(t->wr ? " w " : " r ");
+      uart.disp((int) t->data, 16, 8);
+      uart.disp("\n\r");
+   }
+   io_stats_busy = 0;
+#endif
+}
+
+/**********************************************************************
+ * counters
+ *********************************************************************/
+void io_stats_clear() {
+   int s, r;
+
+   for (s = 0; s <= IO_STATS_SLOTS; s++) {
+      for (r = 0; r < IO_STATS_REGS; r++) {
+         io_stats_rd[s][r] = 0;
+         io_stats_wr[s][r] = 0;
+      }
+   }
+#ifdef _IO_TRACE
+   trace_num = 0;
+#endif
+}
+
+uint32_t io_stats_slot(int slot) {
+   uint32_t sum = 0;
+   int r;
+
+   for (r = 0; r < IO_STATS_REGS; r++)
+      sum = sum + io_stats_rd[slot][r] + io_stats_wr[slot][r];
+   return (sum);
+}
+
+uint32_t io_stats_total() {
+   uint32_t sum = 0;
+   int s;
+
+   for (s = 0; s <= IO_STATS_SLOTS; s++)
+      sum = sum + io_stats_slot(s);
+   return (sum);
+}
+
+void io_stats_dump() {
+   int s, r;
+
+   io_stats_busy = 1;
+   uart.disp("io stats (slot reg: rd / wr):\n\r");
+   for (s = 0; s <= IO_STATS_SLOTS; s++) {
+      for (r = 0; r < IO_STATS_REGS; r++) {
+         if (io_stats_rd[s][r] == 0 && io_stats_wr[s][r] == 0)
+            continue;
+         uart.disp(SLOT_NAME[s]);
+         uart.disp(" ");
+         uart.disp(r, 10, 2);
+         uart.disp(": ");
+         uart.disp((int) io_stats_rd[s][r]);
+         uart.disp(" / ");
+         uart.disp((int) io_stats_wr[s][r]);
+         uart.disp("\n\r");
+      }
+   }
+   uart.disp("total: ");
+   uart.disp((int) io_stats_total());
+   uart.disp("\n\r");
+   io_stats_busy = 0;
+}
+
+#endif  // _IO_STATS
@@ -0,0 +1,143 @@
+/*****************************************************************//**
+ * @file chu_io_stats.h
+ *
+ * @brief per-slot/per-register io access counters and tracer
+ *
+ * Description:
+ *  - enabled by defining _IO_STATS for the whole build
+ *  - io_read()/io_write() (chu_io_rw.h) are routed through
+ *    io_stats_read()/io_stats_write()
+ *  - reads and writes counted per slot (S0_SYS_TIMER to S13_ADSR)
+ *    and per register offset; other slots counted in IO_STATS_SLOTS
+ *  - defining _IO_TRACE in addition records each access in a
+ *    trace ring, timestamped with TimerCore::read_tick32() of the
+ *    system timer (lower 32 bits)
+ *  - accesses generated by the instrumentation itself (time stamp,
+ *    dump over uart) are not counted
+ *  - nothing is compiled when _IO_STATS is not defined
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#ifndef _CHU_IO_STATS_H_INCLUDED
+#define _CHU_IO_STATS_H_INCLUDED
+
+#ifdef _IO_STATS
+
+#include <inttypes.h>
+#include "chu_io_map.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IO_STATS_SLOTS 14    // S0_SYS_TIMER to S13_ADSR
+#define IO_STATS_REGS  32    // register offsets per slot
+
+#ifndef IO_TRACE_DEPTH
+#define IO_TRACE_DEPTH 64    // # entries in trace ring (power of 2)
+#endif
+
+/**
+ * access counters
+ * @note index IO_STATS_SLOTS collects all other slots
+ */
+extern uint32_t io_stats_rd[IO_STATS_SLOTS + 1][IO_STATS_REGS];
+extern uint32_t io_stats_wr[IO_STATS_SLOTS + 1][IO_STATS_REGS];
+
+/**
+ * nonzero while the instrumentation itself accesses io
+ */
+extern int io_stats_busy;
+
+/**
+ * record an access in the trace ring.
+ * @param slot slot #
+ * @param reg register offset
+ * @param wr 0: read; 1: write
+ * @param data data read or written
+ */
+void io_trace_record(int slot, int reg, int wr, uint32_t data);
+
+/**
+ * clear all counters (and the trace ring)
+ */
+void io_stats_clear();
+
+/**
+ * total # reads and writes since last clear
+ */
+uint32_t io_stats_total();
+
+/**
+ * # reads plus writes of a slot since last clear
+ * @param slot slot #
+ */
+uint32_t io_stats_slot(int slot);
+
+/**
+ * print nonzero counters over "uart"
+ */
+void io_stats_dump();
+
+/**
+ * enable/disable trace recording
+ * @param on 1: record; 0: stop recording
+ */
+void io_trace_enable(int on);
+
+/**
+ * print the trace ring (oldest first) over "uart"
+ */
+void io_trace_dump();
+
+// slot index of an access; slots above S13_ADSR share the last entry
+static inline int io_stats_slot_of(uint32_t base_addr, uint32_t offset) {
+   uint32_t slot = (base_addr + 4 * offset - BRIDGE_BASE) >> 7;
+   return ((slot < IO_STATS_SLOTS) ? (int) slot : IO_STATS_SLOTS);
+}
+
+/**
+ * read an io register and count the access
+ */
+static inline uint32_t io_stats_read(uint32_t base_addr, uint32_t offset) {
+   uint32_t data;
+   int slot, reg;
+
+   data = io_read_raw(base_addr, offset);
+   if (!io_stats_busy) {
+      slot = io_stats_slot_of(base_addr, offset);
+      reg = (int) ((base_addr / 4 + offset) & (IO_STATS_REGS - 1));
+      io_stats_rd[slot][reg]++;
+#ifdef _IO_TRACE
+      io_trace_record(slot, reg, 0, data);
+#endif
+   }
+   return (data);
+}
+
+/**
+ * write an io register and count the access
+ */
+static inline void io_stats_write(uint32_t base_addr, uint32_t offset,
+      uint32_t data) {
+   int slot, reg;
+
+   io_write_raw(base_addr, offset, data);
+   if (!io_stats_busy) {
+      slot = io_stats_slot_of(base_addr, offset);
+      reg = (int) ((base_addr / 4 + offset) & (IO_STATS_REGS - 1));
+      io_stats_wr[slot][reg]++;
+#ifdef _IO_TRACE
+      io_trace_record(slot, reg, 1, data);
+#endif
+   }
+}
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif  // _IO_STATS
+
+#endif  // _CHU_IO_STATS_H_INCLUDED
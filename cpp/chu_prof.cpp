@@ -0,0 +1,74 @@
+/*****************************************************************//**
+ * @file chu_prof.cpp
+ *
+ * @brief implementation of scoped profiling probes
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include "chu_prof.h"
+
+#ifdef _PROFILE
+
+prof_site_t prof_table[PROF_SITES];
+static int prof_num = 0;    // # registered sites
+
+int prof_register(const char *name) {
+   int id;
+
+   if (prof_num < PROF_SITES)
+      prof_num++;
+   id = prof_num - 1;
+   if (prof_table[id].name == 0)
+      prof_table[id].name = name;
+   else
+      prof_table[id].name = "(overflow)";
+   prof_table[id].min = 0xffffffff;
+   return (id);
+}
+
+void prof_record(int id, uint32_t ticks) {
+   prof_site_t *p = &prof_table[id];
+
+   p->count++;
+   p->sum = p->sum + ticks;
+   if (ticks < p->min)
+      p->min = ticks;
+   if (ticks > p->max)
+      p->max = ticks;
+}
+
+void prof_clear() {
+   int i;
+
+   for (i = 0; i < prof_num; i++) {
+      prof_table[i].count = 0;
+      prof_table[i].min = 0xffffffff;
+      prof_table[i].max = 0;
+      prof_table[i].sum = 0;
+   }
+}
+
+void prof_dump() {
+   prof_site_t *p;
+   int i;
+
+   uart.disp("profile (site: count min/mean/max us):\n\r");
+   for (i = 0; i < prof_num; i++) {
+      p = &prof_table[i];
+      uart.disp(p->name);
+      uart.disp(": ");
+      uart.disp((int) p->count);
+      if (p->count > 0) {
+         uart.disp(" ");
+         uart.disp((int) ticks32_to_us(p->min));
+         uart.disp("/");
+         uart.disp((int) ticks_to_us(p->sum / p->count));
+         uart.disp("/");
+         uart.disp((int) ticks32_to_us(p->max));
+      }
+      uart.disp("\n\r");
+   }
+}
+
+#endif  // _PROFILE
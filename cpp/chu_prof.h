@@ -0,0 +1,111 @@
+/*****************************************************************//**
+ * @file chu_prof.h
+ *
+ * @brief scoped profiling probes on the system timer
+ *
+ * Description:
+ *  - enabled by defining _PROFILE for the whole build;
+ *    PROF_SCOPE() expands to nothing otherwise
+ *  - PROF_SCOPE("name") measures the time from the statement to the
+ *    end of the enclosing scope (RAII)
+ *  - PROF_RECORD("name", ticks) adds an interval timed by the caller,
+ *    e.g., an asynchronous transfer from start to result
+ *  - each probe site has an entry in a static table holding
+ *    count, min, max and sum of elapsed ticks (system clocks)
+ *  - time stamps read from the lower 32 bits of the system timer
+ *    (now_tick32(); one bus read at each end of the scope);
+ *    a scope must be shorter than 2^32 ticks (42.9 s at 100 MHz)
+ *  - prof_dump() prints the table over "uart"
+ *  - timer reads of the probes are seen by _IO_STATS counters
+ *
+ * Usage:
+ *    void foo() {
+ *       PROF_SCOPE("foo");
+ *       ...
+ *    }
+ *    PROF_RECORD("xfer", elapsed_ticks(xfer_t0));
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#ifndef _CHU_PROF_H_INCLUDED
+#define _CHU_PROF_H_INCLUDED
+
+#ifdef _PROFILE
+
+#include "chu_init.h"
+
+#ifndef PROF_SITES
+#define PROF_SITES 16     // max # probe sites
+#endif
+
+/**
+ * statistics of a probe site
+ */
+typedef struct {
+   const char *name;
+   uint32_t count;        // # completed scopes
+   uint32_t min;          // in ticks
+   uint32_t max;          // in ticks
+   uint64_t sum;          // in ticks
+} prof_site_t;
+
+extern prof_site_t prof_table[PROF_SITES];
+
+/**
+ * register a probe site (once per site)
+ * @param name site name (string literal)
+ * @return site index; last entry shared when the table is full
+ */
+int prof_register(const char *name);
+
+/**
+ * add one measurement to a site
+ * @param id site index
+ * @param ticks elapsed ticks
+ */
+void prof_record(int id, uint32_t ticks);
+
+/**
+ * clear the statistics (sites stay registered)
+ */
+void prof_clear();
+
+/**
+ * print site statistics over "uart"
+ */
+void prof_dump();
+
+/**
+ * RAII probe: time stamp in constructor, record in destructor
+ */
+class ProfScope {
+public:
+   ProfScope(int site) : id(site), start(now_tick32()) {}
+   ~ProfScope() {
+      prof_record(id, now_tick32() - start);
+   }
+private:
+   int id;
+   uint32_t start;
+};
+
+#define PROF_CAT2(a, b) a##b
+#define PROF_CAT(a, b) PROF_CAT2(a, b)
+#define PROF_SCOPE(name) \
+   static int PROF_CAT(_prof_id_, __LINE__) = prof_register(name); \
+   ProfScope PROF_CAT(_prof_, __LINE__)(PROF_CAT(_prof_id_, __LINE__))
+#define PROF_RECORD(name, ticks) \
+   do { \
+      static int _prof_id = prof_register(name); \
+      prof_record(_prof_id, ticks); \
+   } while (0)
+
+#else
+
+#define PROF_SCOPE(name)
+#define PROF_RECORD(name, ticks)
+
+#endif  // _PROFILE
+
+#endif  // _CHU_PROF_H_INCLUDED
@@ -250,4 +250,151 @@ private:
 };
 
 
+/**********************************************************************
+ * slot-bound core drivers
+ **********************************************************************/
+/**
+ * compile-time slot-bound variants of the gpio-type drivers
+ *  - template parameter is the slot # from chu_io_map.h,
+ *    e.g., slot::GpoCore<S2_LED>
+ *  - register addresses are compile-time constants, so each access
+ *    is a single load/store to a fixed address
+ *  - constexpr constructors do not touch the hardware; objects can be
+ *    declared CHU_CONSTINIT so no constructor runs at boot
+ *  - cores that need setup (e.g., pwm frequency) provide init(),
+ *    which must be called before use
+ *  - same methods as the runtime-address classes above
+ */
+namespace slot {
+
+/**
+ * gpi core driver bound to slot SLOT
+ */
+template<int SLOT>
+class GpiCore {
+public:
+   enum {
+      DATA_REG = ::GpiCore::DATA_REG
+   };
+   static constexpr uint32_t base_addr = get_slot_addr(BRIDGE_BASE, SLOT);
+
+   constexpr GpiCore() {
+   }
+
+   uint32_t read() {
+      return (io_read(base_addr, DATA_REG));
+   }
+
+   int read(int bit_pos) {
+      uint32_t rd_data = io_read(base_addr, DATA_REG);
+      return ((int) bit_read(rd_data, bit_pos));
+   }
+};
+
+/**
+ * gpo core driver bound to slot SLOT
+ */
+template<int SLOT>
+class GpoCore {
+public:
+   enum {
+      DATA_REG = ::GpoCore::DATA_REG
+   };
+   static constexpr uint32_t base_addr = get_slot_addr(BRIDGE_BASE, SLOT);
+
+   constexpr GpoCore() : wr_data(0) {
+   }
+
+   void write(uint32_t data) {
+      wr_data = data;
+      io_write(base_addr, DATA_REG, wr_data);
+   }
+
+   void write(int bit_value, int bit_pos) {
+      bit_write(wr_data, bit_pos, bit_value);
+      io_write(base_addr, DATA_REG, wr_data);
+   }
+
+private:
+   uint32_t wr_data;      // same as GPO core data reg
+};
+
+/**
+ * pwm core driver bound to slot SLOT
+ * @note init() sets the default 1K Hz pwm frequency
+ */
+template<int SLOT>
+class PwmCore {
+public:
+   enum {
+      DVSR_REG = ::PwmCore::DVSR_REG,
+      DUTY_REG_BASE = ::PwmCore::DUTY_REG_BASE
+   };
+   enum {
+      RESOLUTION_BITS = ::PwmCore::RESOLUTION_BITS,
+      MAX = ::PwmCore::MAX
+   };
+   static constexpr uint32_t base_addr = get_slot_addr(BRIDGE_BASE, SLOT);
+
+   constexpr PwmCore() {
+   }
+
+   void init() {
+      set_freq(1000);
+   }
+
+   void set_freq(int freq) {
+      uint32_t dvsr;
+      dvsr = (uint32_t) SYS_CLK_FREQ * 1000000 / MAX / freq;
+      io_write(base_addr, DVSR_REG, dvsr);
+   }
+
+   void set_duty(int duty, int channel) {
+      uint32_t d;
+
+      d = (duty > MAX) ? MAX : duty;
+      io_write(base_addr, DUTY_REG_BASE + channel, d);
+   }
+
+   void set_duty(double f, int channel) {
+      set_duty((int) (f * (int) MAX), channel);
+   }
+};
+
+/**
+ * debounce core driver bound to slot SLOT
+ */
+template<int SLOT>
+class DebounceCore {
+public:
+   enum {
+      NORMAL_DATA_REG = ::DebounceCore::NORMAL_DATA_REG,
+      DB_DATA_REG = ::DebounceCore::DB_DATA_REG
+   };
+   static constexpr uint32_t base_addr = get_slot_addr(BRIDGE_BASE, SLOT);
+
+   constexpr DebounceCore() {
+   }
+
+   uint32_t read() {
+      return (io_read(base_addr, NORMAL_DATA_REG));
+   }
+
+   int read(int bit_pos) {
+      uint32_t rd_data = io_read(base_addr, NORMAL_DATA_REG);
+      return ((int) bit_read(rd_data, bit_pos));
+   }
+
+   uint32_t read_db() {
+      return (io_read(base_addr, DB_DATA_REG));
+   }
+
+   int read_db(int bit_pos) {
+      uint32_t rd_data = io_read(base_addr, DB_DATA_REG);
+      return ((int) bit_read(rd_data, bit_pos));
+   }
+};
+
+} // namespace slot
+
 #endif  // _GPIO_H_INCLUDED
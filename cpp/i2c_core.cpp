@@ -12,70 +12,117 @@
 /* methods */
 I2cCore::I2cCore(uint32_t core_base_addr) {
    base_addr = core_base_addr;
-   set_freq(100000);  // default 100K Hz
+   xq_head = 0;
+   xq_tail = 0;
+   dvsr = 0;
+   timeout_us = I2C_TIMEOUT_US;
+   err = I2C_OK;
+   set_freq(I2C_SPEED_STD);  // default 100K Hz
 }
 I2cCore::~I2cCore() {
 }                  // not used
 
-void I2cCore::set_freq(int freq) {
-   uint32_t dvsr;
+int I2cCore::set_freq(int freq) {
+   uint32_t d;
 
    // 25% of i2c period = (1/freq)/4; sys clock period = 1/f_sys
-   // dvsr = # sys clocks =  ((1/freq)/4)/(1/f_sys) = f_sys/freq/4
-   dvsr = (uint32_t) (SYS_CLK_FREQ * 1000000 / freq / 4);
+   // # sys clocks = ((1/freq)/4)/(1/f_sys) = f_sys/freq/4 = dvsr+1
+   d = freq_to_dvsr(freq);
+   if (d == 0)
+      return (-1);
+   write_dvsr(d);
+   return (dvsr_to_freq(dvsr));
+}
+
+// change the divisor only between commands (fsm counts against it)
+void I2cCore::write_dvsr(uint32_t d) {
+   wait_ready();
+   dvsr = d;
    io_write(base_addr, DVSR_REG, dvsr);
 }
 
+int I2cCore::get_freq() {
+   return (dvsr_to_freq(dvsr));
+}
+
+int I2cCore::speed(int n) {
+   static const int table[I2C_SPEED_NUM] = {
+      I2C_SPEED_STD, I2C_SPEED_FAST, I2C_SPEED_FPLUS
+   };
+
+   if (n < 0 || n >= I2C_SPEED_NUM)
+      return (-1);
+   return (table[n]);
+}
+
 int I2cCore::ready() {
    return ((int) (io_read(base_addr,RD_REG) >> 8) & 0x01);
 }
 
-void I2cCore::start() {
-   while (!ready()) {
+// wait until the core takes a command; bounded by the time-out
+int I2cCore::wait_ready() {
+   Deadline dl;
+   int n;
+
+   if (ready())
+      return (I2C_OK);      // common case: no timer access
+   dl.set_us(timeout_us);
+   for (n = 1; !ready(); n++) {
+      // timer read on every 8th status read
+      if ((n & 0x07) == 0 && dl.expired()) {
+         err = I2C_ERR_TIMEOUT;
+         return (I2C_ERR_TIMEOUT);
+      }
    }
-   io_write(base_addr, WR_REG, I2C_START_CMD);
+   return (I2C_OK);
+}
+
+// wait for ready and issue a command
+int I2cCore::cmd(uint32_t data) {
+   if (wait_ready() != I2C_OK)
+      return (I2C_ERR_TIMEOUT);
+   io_write(base_addr, WR_REG, data);
+   return (I2C_OK);
+}
+
+void I2cCore::set_timeout(uint32_t us) {
+   timeout_us = us;
+}
+
+int I2cCore::error() {
+   return (err);
+}
+
+void I2cCore::start() {
+   cmd(I2C_START_CMD);
 }
 
 void I2cCore::restart() {
-   while (!ready()) {
-   }
-   io_write(base_addr, WR_REG, I2C_RESTART_CMD);
+   cmd(I2C_RESTART_CMD);
 }
 
 void I2cCore::stop() {
-   while (!ready()) {
-   }
-   io_write(base_addr, WR_REG, I2C_STOP_CMD);
+   cmd(I2C_STOP_CMD);
 }
 
 int I2cCore::write_byte(uint8_t data) {
-   int ack, acc_data;
+   int ack;
 
-   acc_data = data | I2C_WR_CMD;
-   while (!ready()) {
-   }
-   io_write(base_addr, WR_REG, acc_data);
-   while (!ready()) {
-   }
+   if (cmd(data | I2C_WR_CMD) != I2C_OK || wait_ready() != I2C_OK)
+      return (I2C_ERR_TIMEOUT);
    ack = (io_read(base_addr, RD_REG) & 0x0200) >> 9;
    if (ack == 0)
-      return (0);
+      return (I2C_OK);
    else
       // slave fails to ack
-      return (-1);
+      return (I2C_ERR_NACK);
 }
 
 //last: last byte in read cycle (0:no; 1:yes)
 //      I2C master generate NACK if LSB of last is 1
 int I2cCore::read_byte(int last) {
-   int acc_data;
-
-   acc_data = last | I2C_RD_CMD;
-   while (!ready()) {
-   }
-   io_write(base_addr, WR_REG, acc_data);
-   while (!ready()) {
-   }
+   if (cmd(last | I2C_RD_CMD) != I2C_OK || wait_ready() != I2C_OK)
+      return (I2C_ERR_TIMEOUT);
    return (io_read(base_addr, RD_REG) & 0x00ff);
 }
 
@@ -83,43 +130,284 @@ int I2cCore::read_byte(int last) {
 int I2cCore::read_transaction(uint8_t dev, uint8_t *bytes, int num,
       int rstart) {
    uint8_t dev_byte;
-   int ack1;
+   int ack1, data;
    int i;
 
+   err = I2C_OK;
    dev_byte = (dev << 1) | 0x01;   // LSB=1 for I2c read
    start();
+   if (err != I2C_OK)
+      return (err);
    ack1 = write_byte(dev_byte);    // send device id/read
-   for (i = 0; i < (num - 1); i++) {
-      *bytes = read_byte(0);
+   if (ack1 != I2C_OK) {
+      // no device: release the bus without reading
+      if (ack1 == I2C_ERR_NACK)
+         stop();
+      return (ack1);
+   }
+   for (i = 0; i < num; i++) {
+      data = read_byte((i == num - 1) ? 1 : 0);   // NACK the last byte
+      if (data < 0)
+         return (data);
+      *bytes = (uint8_t) data;
       bytes++;
    }
-   *bytes = read_byte(1);   // last byte in read cycle
    if (rstart == 1) {
       restart();
    } else {
       stop();
    }
-   return (ack1);
+   return (err);
 }
 
 int I2cCore::write_transaction(uint8_t dev, uint8_t *bytes, int num,
       int rstart) {
    uint8_t dev_byte;
-   int ack1, ack;
+   int ack;
    int i;
 
+   err = I2C_OK;
    dev_byte = (dev << 1);   // LSB=0 for I2c write
    start();
+   if (err != I2C_OK)
+      return (err);
    ack = write_byte(dev_byte);  // send device id/write
-   for (i = 0; i < num; i++) {
-      ack1 = write_byte(*bytes);
-      ack = ack + ack1;
+   for (i = 0; i < num && ack == I2C_OK; i++) {
+      ack = write_byte(*bytes);
       bytes++;
    }
-   if (rstart == 1) {
-      restart();
+   if (ack == I2C_ERR_TIMEOUT)
+      return (ack);
+   if (ack == I2C_ERR_NACK || rstart != 1) {
+      stop();
    } else {
+      restart();
+   }
+   return ((err != I2C_OK) ? err : ack);
+}
+
+int I2cCore::probe(uint8_t dev) {
+   int ack;
+
+   err = I2C_OK;
+   start();
+   if (err != I2C_OK)
+      return (err);
+   ack = write_byte(dev << 1);
+   if (ack == I2C_ERR_TIMEOUT)
+      return (ack);
+   stop();
+   return ((err != I2C_OK) ? err : ack);
+}
+
+int I2cCore::recover() {
+   err = I2C_OK;
+   // start (restart if the bus is held), 9 scl pulses with sda
+   // released by the master (read with NACK), then stop
+   start();
+   if (err == I2C_OK)
+      read_byte(1);
+   if (err == I2C_OK)
       stop();
+   if (err == I2C_OK)
+      wait_ready();
+   return (err);
+}
+
+// PROBE_TRIES acks in a row
+int I2cCore::probe_clean(uint8_t dev) {
+   int i;
+
+   for (i = 0; i < PROBE_TRIES; i++)
+      if (probe(dev) != 0)
+         return (-1);
+   return (0);
+}
+
+int I2cCore::scan(uint8_t *map) {
+   uint32_t old = dvsr;
+   int n, dev, found;
+
+   for (dev = 0; dev < 128; dev++)
+      map[dev] = 0;
+   for (n = 0; n < I2C_SPEED_NUM; n++) {
+      if (set_freq(speed(n)) < 0)
+         continue;
+      for (dev = SCAN_FIRST; dev <= SCAN_LAST; dev++)
+         if (probe(dev) == 0)
+            map[dev] |= 1 << n;
+   }
+   found = 0;
+   for (dev = SCAN_FIRST; dev <= SCAN_LAST; dev++)
+      if (map[dev])
+         found++;
+   write_dvsr(old);
+   return (found);
+}
+
+int I2cCore::select_speed(uint8_t dev, uint32_t max_hz, const uint8_t *map) {
+   uint32_t old = dvsr;
+   int n, best;
+
+   // climb from the slowest profile; stop at the first failure
+   best = -1;
+   for (n = 0; n < I2C_SPEED_NUM; n++) {
+      if ((uint32_t) speed(n) > max_hz)
+         break;
+      if (map && !(map[dev & 0x7f] & (1 << n)))
+         break;
+      if (set_freq(speed(n)) < 0)
+         break;
+      if (probe_clean(dev) != 0)
+         break;
+      best = n;
+   }
+   if (best < 0) {
+      write_dvsr(old);
+      return (-1);
+   }
+   return (set_freq(speed(best)));
+}
+
+/*
+ * asynchronous transaction engine
+ *  - phase: next command group to issue
+ *  - pend: result expected from the command on the bus
+ */
+enum {
+   PH_START, PH_WADDR, PH_WDATA, PH_RADDR, PH_RDATA,
+   PH_RECOVER, PH_RCLK, PH_RSTOP, PH_END
+};
+enum {
+   PEND_NONE, PEND_ACK, PEND_DATA
+};
+
+int I2cCore::submit(I2cXfer *x) {
+   if (x->status == XFER_QUEUED || x->status == XFER_BUSY)
+      return (-1);
+   x->next = 0;
+   x->phase = PH_START;
+   x->idx = 0;
+   x->pend = PEND_NONE;
+   x->waits = 0;
+   x->nack = 0;
+   x->status = XFER_QUEUED;
+   if (xq_tail)
+      xq_tail->next = x;
+   else
+      xq_head = x;
+   xq_tail = x;
+   return (0);
+}
+
+int I2cCore::submit_recover(I2cXfer *x) {
+   if (submit(x) != 0)
+      return (-1);
+   x->wr_num = 0;
+   x->rd_num = 0;
+   x->restart = 0;
+   x->phase = PH_RECOVER;
+   return (0);
+}
+
+int I2cCore::xfer_busy() {
+   return (xq_head != 0);
+}
+
+// command following the completed one; advances the phase
+uint32_t I2cCore::xfer_step(I2cXfer *x) {
+   switch (x->phase) {
+   case PH_START:
+      x->phase = (x->wr_num > 0 || x->rd_num == 0) ? PH_WADDR : PH_RADDR;
+      return (I2C_START_CMD);
+   case PH_WADDR:
+      x->phase = PH_WDATA;
+      x->pend = PEND_ACK;
+      return (I2C_WR_CMD | (x->dev << 1));    // LSB=0 for I2c write
+   case PH_WDATA:
+      if (x->idx < x->wr_num) {
+         x->pend = PEND_ACK;
+         return (I2C_WR_CMD | x->wr[x->idx++]);
+      }
+      if (x->rd_num > 0) {
+         x->phase = PH_RADDR;
+         return (I2C_RESTART_CMD);
+      }
+      break;
+   case PH_RADDR:
+      x->phase = PH_RDATA;
+      x->idx = 0;
+      x->pend = PEND_ACK;
+      return (I2C_WR_CMD | (x->dev << 1) | 0x01);   // LSB=1 for I2c read
+   case PH_RDATA:
+      if (x->idx < x->rd_num) {
+         x->pend = PEND_DATA;
+         // last byte in read cycle: master NACKs
+         return (I2C_RD_CMD | ((x->idx == x->rd_num - 1) ? 1 : 0));
+      }
+      break;
+   case PH_RECOVER:
+      // recover(): start, one read with NACK (result dropped), stop
+      x->phase = PH_RCLK;
+      return (I2C_START_CMD);
+   case PH_RCLK:
+      x->phase = PH_RSTOP;
+      return (I2C_RD_CMD | 1);
+   }
+   // end of transaction
+   x->phase = PH_END;
+   return ((x->restart == 1) ? I2C_RESTART_CMD : I2C_STOP_CMD);
+}
+
+// remove the head transaction and report it
+void I2cCore::xfer_end(I2cXfer *x, int status) {
+   xq_head = x->next;
+   if (xq_head == 0)
+      xq_tail = 0;
+   x->status = status;
+   if (x->done)
+      x->done(x);
+}
+
+int I2cCore::poll() {
+   I2cXfer *x = xq_head;
+   uint32_t rd, word;
+
+   if (x == 0)
+      return (0);
+   rd = io_read(base_addr, RD_REG);
+   if (((rd >> 8) & 0x01) == 0) {
+      // command still on the bus; bounded by the time-out
+      // (timer read on the 1st and every 8th busy poll)
+      x->waits++;
+      if (x->waits == 1) {
+         x->dl.set_us(timeout_us);
+      } else if ((x->waits & 0x07) == 0 && x->dl.expired()) {
+         xfer_end(x, XFER_TIMEOUT);
+         return (xq_head != 0);
+      }
+      return (1);
+   }
+   x->waits = 0;
+   // collect the result of the completed command
+   if (x->pend == PEND_ACK && (rd & 0x0200))
+      x->nack = 1;
+   else if (x->pend == PEND_DATA)
+      x->rd[x->idx++] = (uint8_t) rd;
+   x->pend = PEND_NONE;
+   if (x->phase != PH_END) {
+      x->status = XFER_BUSY;
+      if (x->nack) {
+         // abandon the transaction; release the bus
+         x->phase = PH_END;
+         word = I2C_STOP_CMD;
+      } else {
+         word = xfer_step(x);
+      }
+      io_write(base_addr, WR_REG, word);
+      return (1);
    }
-   return (ack);
+   // stop/restart done: transaction complete
+   xfer_end(x, x->nack ? XFER_NACK : XFER_DONE);
+   return (xq_head != 0);
 }
@@ -7,6 +7,16 @@
  * - 5 basic commands: start, read, write, stop, restart
  * - i2c transaction can be "assembled" with commands
  *   e.g., start, write, write, stop
+ * - asynchronous transactions: a descriptor is queued by submit()
+ *   and advanced one command per poll(); the cpu is not held while
+ *   the bus is busy
+ * - speed profiles: standard (100K), fast (400K), fast-plus (1M)
+ *   nominal; the divisor also meets the mode's minimum scl low time
+ *   (4.7/1.3/0.5 us), so fast mode runs at 384.6K Hz @100 MHz;
+ *   bus scan and per-device selection of the fastest clean speed
+ *   within the device limit
+ * - every wait for the core is bounded by a time-out (system timer);
+ *   transactions return typed errors and abort on the first failure
  *
  * @author p chu
  * @version v1.0: initial release
@@ -17,6 +27,35 @@
 
 #include "chu_init.h"
 
+/**
+ * asynchronous i2c transaction descriptor
+ *  - write phase: start, dev+w, wr[0..wr_num-1]
+ *  - read phase: (re)start, dev+r, rd_num reads (last one NACKed)
+ *  - either phase may be empty; with both empty the address alone
+ *    is written (probe)
+ *  - ended by stop or, if restart is 1, by restart
+ *  - descriptor and buffers must stay valid until completion
+ */
+struct I2cXfer {
+   uint8_t dev;               // 7-bit device address
+   const uint8_t *wr;         // bytes written after dev+w
+   int wr_num;
+   uint8_t *rd;               // buffer of bytes read
+   int rd_num;
+   int restart;               // 1: end with restart; 0: end with stop
+   void (*done)(I2cXfer *x);  // completion callback (may be 0)
+   void *arg;                 // user data for the callback
+   volatile int status;       // I2cCore::XFER_xxx
+   /* engine state */
+   I2cXfer *next;
+   int phase;
+   int idx;
+   int pend;
+   int nack;                  // 1: a byte was not acked
+   int waits;                 // busy polls of the current command
+   Deadline dl;               // time-out of the current command
+};
+
 /**
  * i2c core driver
  * - access MMIO i2c core
@@ -53,6 +92,74 @@ public:
       I2C_STOP_CMD = 0x03 << 8,   /**< stop command */
       I2C_RESTART_CMD = 0x04 << 8 /**< restart command */
    };
+   /**
+    * speed profiles (scl frequency in Hz), slowest first
+    *
+    */
+   enum {
+      I2C_SPEED_STD = 100000,     /**< standard mode */
+      I2C_SPEED_FAST = 400000,    /**< fast mode */
+      I2C_SPEED_FPLUS = 1000000,  /**< fast mode plus */
+      I2C_SPEED_NUM = 3           /**< # profiles */
+   };
+   /**
+    * divisor limits
+    *
+    * scl period is 4*(dvsr+1) system clocks, scl low 2*(dvsr+1);
+    * i2c_master doubles dvsr in a 16-bit counter, so dvsr must stay
+    * below 2^15
+    */
+   enum {
+      DVSR_MIN = 1,
+      DVSR_MAX = 0x7fff
+   };
+   /**
+    * minimum scl low time (ns) of the i2c modes
+    *
+    */
+   enum {
+      TLOW_STD_NS = 4700,   /**< up to 100K Hz */
+      TLOW_FAST_NS = 1300,  /**< up to 400K Hz */
+      TLOW_FPLUS_NS = 500   /**< up to 1M Hz */
+   };
+   /**
+    * scan parameters
+    *
+    */
+   enum {
+      SCAN_FIRST = 0x08,   /**< 0x00-0x07 and 0x78-0x7f reserved */
+      SCAN_LAST = 0x77,
+      PROBE_TRIES = 3      /**< consecutive acks of a clean speed */
+   };
+   /**
+    * asynchronous transaction status
+    *
+    */
+   enum {
+      XFER_IDLE = 0,   /**< never submitted */
+      XFER_QUEUED,     /**< waiting for earlier transactions */
+      XFER_BUSY,       /**< on the bus */
+      XFER_DONE,       /**< completed; all bytes acked */
+      XFER_NACK,       /**< completed; address or data not acked */
+      XFER_TIMEOUT     /**< abandoned; core not ready in time */
+   };
+   /**
+    * error codes of the blocking methods
+    *
+    */
+   enum {
+      I2C_OK = 0,
+      I2C_ERR_NACK = -1,     /**< address or data byte not acked */
+      I2C_ERR_TIMEOUT = -2   /**< core not ready before the time-out */
+   };
+   /**
+    * default time-out of a single command (us)
+    *
+    * a byte takes 90 us at 100K Hz
+    */
+   enum {
+      I2C_TIMEOUT_US = 1000
+   };
    /* methods */
    /**
     * constructor
@@ -66,9 +173,100 @@ public:
     * set i2c clock (sclk) frequency
     *
     * @param freq i2c clock frequency
+    * @return achieved frequency (Hz); -1: out of range (unchanged)
+    *
+    * @note divisor rounded up, and raised to meet the minimum scl
+    *       low time of the mode freq falls in, so the achieved
+    *       frequency never exceeds freq; e.g., 400K Hz gives
+    *       384.6K Hz @100 MHz (scl low 1.3 us)
+    * @note waits for the current command to finish
+    *
+    */
+   int set_freq(int freq);
+
+   /**
+    * achieved i2c clock frequency of the current divisor (Hz)
+    *
+    */
+   int get_freq();
+
+   /**
+    * frequency of a speed profile
+    *
+    * @param n profile # (0: slowest)
+    *
+    */
+   static int speed(int n);
+
+   /**
+    * probe a device address (start, write address, stop)
+    *
+    * @param dev device id
+    * @return I2C_OK; I2C_ERR_NACK; I2C_ERR_TIMEOUT
+    *
+    */
+   int probe(uint8_t dev);
+
+   /**
+    * set the time-out of a single command
+    *
+    * @param us time-out in us (default I2C_TIMEOUT_US)
+    *
+    * @note a transaction gives up after the first time-out, so its
+    *       worst case is about one time-out plus its normal duration
+    *
+    */
+   void set_timeout(uint32_t us);
+
+   /**
+    * error of the last blocking transaction (I2C_OK if none)
+    *
+    * @note also set by a time-out in start()/restart()/stop()
     *
     */
-   void set_freq(int freq);
+   int error();
+
+   /**
+    * bus recovery
+    *
+    * @return I2C_OK; I2C_ERR_TIMEOUT
+    *
+    * @note the core cannot drive scl directly; the sequence is a
+    *       start, one read with NACK (9 scl pulses with sda released,
+    *       letting a device stuck in a read cycle finish it) and a stop
+    *
+    */
+   int recover();
+
+   /**
+    * probe all non-reserved addresses at every speed profile
+    *
+    * @param map 128 entries; bit n of map[dev] set if dev acked at
+    *        profile n; reserved addresses cleared
+    * @return # devices acking at any speed
+    *
+    * @note current frequency restored afterwards
+    *
+    */
+   int scan(uint8_t *map);
+
+   /**
+    * select the fastest clean speed of a device
+    *
+    * @param dev device id
+    * @param max_hz fastest scl the device supports (data sheet);
+    *        faster profiles are not tried
+    * @param map scan result; 0 to probe directly
+    * @return selected frequency (set); -1: no ack at any speed
+    *         (frequency unchanged)
+    *
+    * @note a speed is clean if the device acks PROBE_TRIES probes
+    *       in a row at it and at every slower profile
+    * @note an address ack does not prove data integrity; hence the
+    *       device limit
+    *
+    */
+   int select_speed(uint8_t dev, uint32_t max_hz, const uint8_t *map = 0);
 
    /**
     * indicate whether i2c core is ready to take a command
@@ -98,7 +296,7 @@ public:
     * issue a write command
     *
     * @param data 8-bit data
-    * @return device ack status (0: ok; -1: failed)
+    * @return I2C_OK; I2C_ERR_NACK; I2C_ERR_TIMEOUT
     *
     */
    int write_byte(uint8_t data);
@@ -107,7 +305,7 @@ public:
     * issue a read command
     *
     * @param last indicates the last byte in read cycle (0: no; 1:yes)
-    * @return 8-bit read data
+    * @return 8-bit read data; I2C_ERR_TIMEOUT
     *
     * @note last byte in read cycle forces i2c master generating NACK
     *
@@ -123,7 +321,8 @@ public:
     * @param num number of bytes to be read
     * @param restart 1:issue "restart" command in the end; 0:issue "stop" command
     *
-    * @return device ack status (0: ok; -1: # failed ack)
+    * @return I2C_OK; I2C_ERR_NACK (no device; nothing read);
+    *         I2C_ERR_TIMEOUT (aborted)
     * @return retrieved data store in bytes array
     *
     * @note command sequence: start, write dev, read, .. read, stop/restart
@@ -140,7 +339,8 @@ public:
     * @param num number of bytes to be written
     * @param restart 1:issue "restart" command in the end; 0:issue "stop" command
     *
-    * @return device ack status (0: ok; negative: # failed acks)
+    * @return I2C_OK; I2C_ERR_NACK (stopped at the byte not acked);
+    *         I2C_ERR_TIMEOUT (aborted)
     *
     * @note command sequence: start, write dev, write, .. write, stop/restart
     *
@@ -148,10 +348,103 @@ public:
    int write_transaction(uint8_t dev, uint8_t *bytes, int num,
          int restart);
 
+   /**
+    * queue an asynchronous transaction
+    *
+    * @param x transaction descriptor (status set to XFER_QUEUED)
+    * @return 0: ok; -1: descriptor already queued
+    *
+    * @note no bus access; transactions run in submission order
+    *       from poll()
+    * @note do not call the blocking methods while transactions
+    *       are pending
+    *
+    */
+   int submit(I2cXfer *x);
+
+   /**
+    * queue an asynchronous bus recovery (see recover())
+    *
+    * @param x transaction descriptor; only done and arg are used
+    * @return 0: ok; -1: descriptor already queued
+    *
+    * @note status XFER_DONE or XFER_TIMEOUT on completion
+    *
+    */
+   int submit_recover(I2cXfer *x);
+
+   /**
+    * advance the current asynchronous transaction
+    *
+    * @return 1: transactions pending; 0: queue empty
+    *
+    * @note one status read per call; when the core is ready the
+    *       result of the last command is collected and the next
+    *       command issued
+    * @note on completion the status is set and the callback
+    *       invoked; the callback may submit a new transaction
+    * @note a command not finished within the time-out abandons the
+    *       transaction (XFER_TIMEOUT)
+    *
+    */
+   int poll();
+
+   /**
+    * 1 if asynchronous transactions are pending
+    *
+    */
+   int xfer_busy();
+
+   /**
+    * divisor of an i2c clock frequency (rounded up; scl low time
+    * at least the minimum of the mode freq falls in)
+    *
+    * @return divisor; 0: out of range
+    */
+   static uint32_t freq_to_dvsr(int freq) {
+      uint32_t q, q_low, t_low;
+
+      if (freq <= 0)
+         return (0);
+      // quarter period in sys clocks, rounded up; dvsr = quarter - 1
+      q = (uint32_t) (((uint64_t) SYS_CLK_FREQ * 1000000 + 4 * (uint64_t) freq - 1)
+            / (4 * (uint64_t) freq));
+      // scl low = 2 quarters >= t_low
+      if (freq <= I2C_SPEED_STD)
+         t_low = TLOW_STD_NS;
+      else if (freq <= I2C_SPEED_FAST)
+         t_low = TLOW_FAST_NS;
+      else
+         t_low = TLOW_FPLUS_NS;
+      q_low = (t_low * SYS_CLK_FREQ + 1999) / 2000;
+      if (q < q_low)
+         q = q_low;
+      if (q < DVSR_MIN + 1 || q > DVSR_MAX + 1)
+         return (0);
+      return (q - 1);
+   }
+
+   /**
+    * i2c clock frequency of a divisor
+    */
+   static int dvsr_to_freq(uint32_t dvsr) {
+      return ((int) (SYS_CLK_FREQ * 1000000 / (4 * (dvsr + 1))));
+   }
+
 private:
    /* variable to keep track of current status */
    uint32_t base_addr;
-
+   uint32_t dvsr;       // current divisor
+   uint32_t timeout_us; // time-out of a single command
+   int err;             // error of the last blocking transaction
+   I2cXfer *xq_head;    // asynchronous transaction queue
+   I2cXfer *xq_tail;
+   uint32_t xfer_step(I2cXfer *x);
+   void xfer_end(I2cXfer *x, int status);
+   int probe_clean(uint8_t dev);
+   void write_dvsr(uint32_t d);
+   int wait_ready();
+   int cmd(uint32_t data);
 };
 
 #endif  //_I2C_CORE_H_INCLUDED
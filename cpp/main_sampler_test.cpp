@@ -8,22 +8,79 @@
  *********************************************************************/
 
 // #define _DEBUG
-#include "adsr_core.h"
 #include "chu_init.h"
-#include "ddfs_core.h"
 #include "gpio_cores.h"
 #include "i2c_core.h"
-#include "ps2_core.h"
+#include "adt7420_core.h"
 #include "sseg_core.h"
 #include "spi_core.h"
+#include "adxl362_core.h"
 #include "xadc_core.h"
-
-GpoCore led(get_slot_addr(BRIDGE_BASE, S2_LED));
-GpiCore sw(get_slot_addr(BRIDGE_BASE, S3_SW));
-DebounceCore btn(get_slot_addr(BRIDGE_BASE, S7_BTN));
-SsegCore sseg(get_slot_addr(BRIDGE_BASE, S8_SSEG));
-I2cCore adt7420(get_slot_addr(BRIDGE_BASE, S10_I2C));
-PwmCore pwm(get_slot_addr(BRIDGE_BASE, S6_PWM));
+#include "chu_prof.h"
+#include "telemetry.h"
+#include "temp_window.h"
+#include "temperature.h"
+#include "temp_history.h"
+#include "temp_filter.h"
+#include "temp_log.h"
+#include "temp_trend.h"
+#include "sample_sched.h"
+#include "sample_adapt.h"
+
+// fixed-slot cores bound at compile time (see gpio_cores.h): register
+// addresses are constants and no constructor runs at boot; pwm and
+// sseg set up by init() in main()
+typedef slot::GpoCore<S2_LED> Led;
+typedef slot::GpiCore<S3_SW> Sw;
+typedef slot::DebounceCore<S7_BTN> Btn;
+typedef slot::SsegCore<S8_SSEG> Sseg;
+typedef slot::PwmCore<S6_PWM> Pwm;
+CHU_CONSTINIT Led led;
+CHU_CONSTINIT Sw sw;
+CHU_CONSTINIT Btn btn;
+CHU_CONSTINIT Sseg sseg;
+CHU_CONSTINIT Pwm pwm;
+I2cCore i2c(get_slot_addr(BRIDGE_BASE, S10_I2C));
+Adt7420 adt7420(&i2c);
+XadcCore xadc(get_slot_addr(BRIDGE_BASE, S5_XDAC));
+SpiCore spi(get_slot_addr(BRIDGE_BASE, S9_SPI));
+Adxl362 acl(&spi);
+
+// console output: text lines (default) or binary telemetry records;
+// selected by 't'/'b' received on the serial port
+bool tlm_bin = false;
+
+// background sampling: one read every SAMPLE_MS on a fixed grid (the
+// ADT7420 converts every 240 ms); good samples feed the AVG baseline
+// window; DIFF reports every DIFF_SAMPLES samples
+#define SAMPLE_MS 250
+#define DIFF_SAMPLES 2
+SampleSched sampler(SAMPLE_MS);
+// the sensor is read on every grid tick while the temperature changes,
+// less often while stable (see sample_adapt.h); skipped ticks repeat
+// the last sample, so consumers keep the fixed cadence
+#define SAMPLE_HELD 2       // sample_take() rc: repeated sample
+SampleAdapt adapt;
+uint32_t read_t0 = 0;       // tick32 of the last read start
+uint32_t read_us = 0;       // duration of the last read (start to result)
+TempWindow baseline_win;
+TempHistory history(SAMPLE_MS);   // every sample period; stale ones as last good
+TempLog sample_log;         // raw codes of new reads; dumped by 'l'
+uint32_t log_gap = 0;       // sampler ticks since the last logged read
+TempTrend trend(SAMPLE_MS); // slope of the last TREND_LEN filter inputs
+bool trend_shown = false;   // LIVE shows the trend (SW4); RGB LEDs lit
+bool sample_new = false;    // sample completed since last displayed
+uint32_t sample_seq = 0;    // # samples completed
+uint16_t sample_raw = 0;    // latest sample (last good one if stale)
+// display/DIFF path filtered; type set by switches 3-1 (see filter_sw())
+TempFilter sample_filt;
+Temperature sample_temp;    // latest filtered sample
+int32_t sample_in = 0;      // latest filter input (1/128 C)
+// backup sensor: FPGA die temperature minus its offset to ambient,
+// learned from good ADT7420 samples; shown while reads fail
+#define DIE_OFFSET_SHIFT 3
+int32_t die_offset = 0;     // die - ambient, 1/128 C
+bool die_offset_ok = false;
 /**
  * Class definition of Interface
  */
@@ -37,9 +94,12 @@ enum class Interface {
 /**
  * Determine the current menu selection based on button presses.
  */
-Interface check_btn(DebounceCore *db_p, GpoCore *led_p, bool &RST_BTN, bool &LIVE_BTN, bool &Z_BTN) {
+Interface check_btn(Btn *db_p, Led *led_p, bool &RST_BTN, bool &LIVE_BTN, bool &Z_BTN) {
    int s = db_p->read();
    Interface c_menu = Interface::IDLE;
+   if (s != 0) {
+      adapt.kick();   // user activity: fastest sampling
+   }
    if (s == 1) {
       RST_BTN = true;
       LIVE_BTN = false;
@@ -62,8 +122,11 @@ Interface check_btn(DebounceCore *db_p, GpoCore *led_p, bool &RST_BTN, bool &LIV
 /**
  * Track additional button presses while in the DIFF menu.
  */
-void check_btn_r(DebounceCore *db_p, bool &AVG_BTN, bool &DIFF_BTN) {
+void check_btn_r(Btn *db_p, bool &AVG_BTN, bool &DIFF_BTN) {
    int s = db_p->read();
+   if (s != 0) {
+      adapt.kick();
+   }
    if (s == 2) {
       AVG_BTN = true;
    } else if (s == 8) {
@@ -72,45 +135,56 @@ void check_btn_r(DebounceCore *db_p, bool &AVG_BTN, bool &DIFF_BTN) {
 }
 
 
-/** Clear every digit on the seven-segment display. */
-void sseg_clear(SsegCore *sseg_t) {
-   for (int i = 0; i < 9; i++) {
+/** Clear every digit and decimal point on the seven-segment display. */
+void sseg_clear(Sseg *sseg_t) {
+   sseg_t->begin();
+   for (int i = 0; i < 8; i++) {
       sseg_t->write_1ptn(0xFF, i);
    }
+   sseg_t->set_dp(0x00);
+   sseg_t->commit();
 }
 
 /** Show "RST" to indicate the DIFF menu. */
-void disp_RST(SsegCore *sseg_t) {
+void disp_RST(Sseg *sseg_t) {
+   sseg_t->begin();
    sseg_t->set_dp(0x00);
    sseg_t->write_1ptn(0xAF, 2);  // R (small r)
    sseg_t->write_1ptn(0x92, 1);  // S (looks like 5)
    sseg_t->write_1ptn(0x87, 0);  // T (small t)
+   sseg_t->commit();
 }
 
 /** Show "AVG" to indicate the averaging option. */
-void disp_AVG(SsegCore *sseg_t) {
+void disp_AVG(Sseg *sseg_t) {
+   sseg_t->begin();
    sseg_t->set_dp(0x00);
    sseg_t->write_1ptn(0x88, 2);  // A
    sseg_t->write_1ptn(0xC1, 1);  // V (looks like U)
    sseg_t->write_1ptn(0x90, 0);  // G (looks like 9/g)
+   sseg_t->commit();
 }
 
 /** Show "DIFF" to indicate the difference display. */
-void disp_DIFF(SsegCore *sseg_t) {
+void disp_DIFF(Sseg *sseg_t) {
+   sseg_t->begin();
    sseg_t->set_dp(0x00);
    sseg_t->write_1ptn(0xA1, 3);  // D (small d)
    sseg_t->write_1ptn(0xF9, 2);  // I (looks like 1)
    sseg_t->write_1ptn(0x8E, 1);  // F
    sseg_t->write_1ptn(0x8E, 0);  // F
+   sseg_t->commit();
 }
 
 /** Show "LIVE" to indicate live temperature mode. */
-void disp_LIVE(SsegCore *sseg_t) {
+void disp_LIVE(Sseg *sseg_t) {
+   sseg_t->begin();
    sseg_t->set_dp(0x00);
    sseg_t->write_1ptn(0xC7, 3);  // L
    sseg_t->write_1ptn(0xF9, 2);  // I
    sseg_t->write_1ptn(0xC1, 1);  // V (uses U pattern)
    sseg_t->write_1ptn(0x86, 0);  // E
+   sseg_t->commit();
 }
 
 
@@ -119,16 +193,18 @@ void disp_LIVE(SsegCore *sseg_t) {
  * Display a temperature difference on the seven-segment display and drive the
  * PWM outputs based on direction.
  */
-void temp_diff(float temp, SsegCore *sseg_t, PwmCore *pwm_p) {
+void temp_diff(Temperature temp, Sseg *sseg_t, Pwm *pwm_p) {
+   PROF_SCOPE("temp_diff");
+   sseg_t->begin();
    sseg_t->set_dp(0x00);
 
    bool is_negative = false;
-   if (temp < 0.0) {
+   if (temp < Temperature()) {
       is_negative = true;
       temp = -temp;
    }
 
-   int temp_input = static_cast<int>(temp * 1000.0 + 0.5);
+   int temp_input = temp.c_scaled(1000);   // m-degree, rounded
    int temp_array[5];
    temp_array[0] = (temp_input / 10000) % 10;
    temp_array[1] = (temp_input / 1000) % 10;
@@ -149,7 +225,7 @@ void temp_diff(float temp, SsegCore *sseg_t, PwmCore *pwm_p) {
       pwm_p->set_duty(1023, 0);
       pwm_p->set_duty(0, 1);
       pwm_p->set_duty(0, 2);
-   } else if (temp == 0) {
+   } else if (temp == Temperature()) {
       pwm_p->set_duty(0, 0);
       pwm_p->set_duty(1, 1);
       pwm_p->set_duty(0, 2);
@@ -164,12 +240,15 @@ void temp_diff(float temp, SsegCore *sseg_t, PwmCore *pwm_p) {
          sseg_t->write_1ptn(sseg_t->h2s(temp_array[0]), 5);
       }
    }
+   sseg_t->commit();
 }
 
 /** Display a temperature reading in Celsius. */
-void temp_disp_C(float temp, SsegCore *sseg_t) {
+void temp_disp_C(Temperature temp, Sseg *sseg_t) {
+   PROF_SCOPE("temp_disp_C");
+   sseg_t->begin();
    sseg_t->set_dp(0x00);
-   int temp_input = static_cast<int>(temp * 1000.0);
+   int temp_input = temp.c_scaled(1000);   // m-degree C, rounded
    int temp_array[5];
    temp_array[0] = (temp_input / 10000) % 10;
    temp_array[1] = (temp_input / 1000) % 10;
@@ -185,12 +264,15 @@ void temp_disp_C(float temp, SsegCore *sseg_t) {
    sseg_t->write_1ptn(sseg_t->h2s(temp_array[2]), 3);
    sseg_t->write_1ptn(sseg_t->h2s(temp_array[3]), 2);
    sseg_t->write_1ptn(sseg_t->h2s(temp_array[4]), 1);
+   sseg_t->commit();
 }
 
 /** Display a temperature reading in Fahrenheit. */
-void temp_disp_F(float temp, SsegCore *sseg_t) {
+void temp_disp_F(Temperature temp, Sseg *sseg_t) {
+   PROF_SCOPE("temp_disp_F");
+   sseg_t->begin();
    sseg_t->set_dp(0x00);
-   int temp_input = static_cast<int>(temp * 1000.0);
+   int temp_input = temp.f_scaled(1000);   // m-degree F, rounded
    int temp_array[5];
    temp_array[0] = (temp_input / 10000) % 10;
    temp_array[1] = (temp_input / 1000) % 10;
@@ -206,125 +288,423 @@ void temp_disp_F(float temp, SsegCore *sseg_t) {
    sseg_t->write_1ptn(sseg_t->h2s(temp_array[2]), 3);
    sseg_t->write_1ptn(sseg_t->h2s(temp_array[3]), 2);
    sseg_t->write_1ptn(sseg_t->h2s(temp_array[4]), 1);
+   sseg_t->commit();
 }
 
 
 
 /**
- * Read the ADT7420 temperature sensor and return the temperature in Celsius.
+ * Send one binary telemetry record (see telemetry.h): raw register,
+ * baseline, latest filtered sample and sensor status.
  */
-float adt7420_read(I2cCore *adt7420_p) {
-   const uint8_t DEV_ADDR = 0x4b;
-   uint8_t wbytes[2], bytes[2];
-   uint16_t tmp;
-   float tmpC;
-
-   wbytes[0] = 0x0b;
-   adt7420_p->write_transaction(DEV_ADDR, wbytes, 1, 1);
-   adt7420_p->read_transaction(DEV_ADDR, bytes, 1, 0);
-   uart.disp("read ADT7420 id (should be 0xcb): ");
-   uart.disp(bytes[0], 16);
-   uart.disp("\n\r");
-
-   wbytes[0] = 0x00;
-   adt7420_p->write_transaction(DEV_ADDR, wbytes, 1, 1);
-   adt7420_p->read_transaction(DEV_ADDR, bytes, 2, 0);
-
-   tmp = (uint16_t)bytes[0];
-   tmp = (tmp << 8) + (uint16_t)bytes[1];
-   if (tmp & 0x8000) {
-      tmp = tmp >> 3;
-      tmpC = (float)((int)tmp - 8192) / 16;
-   } else {
-      tmp = tmp >> 3;
-      tmpC = (float)tmp / 16;
+void tlm_send(uint8_t mode, uint16_t raw, Temperature baseline) {
+   tlm_sample_t rec;
+   uint8_t buf[TLM_SAMPLE_LEN];
+
+   rec.mode = mode;
+   rec.res16 = (uint8_t) adt7420.res16();
+   rec.ts = (uint32_t) (now_tick() >> TLM_TS_SHIFT);
+   rec.raw = raw;
+   rec.baseline = (int16_t) baseline.q7();
+   rec.temp = (int16_t) sample_temp.q7();
+   rec.status = 0;
+   if (adt7420.stale()) {
+      rec.status = TLM_STAT_STALE | (die_offset_ok ? TLM_STAT_BACKUP : 0);
    }
+   tlm_pack(&rec, buf);
+   uart.tx_frame(buf, TLM_SAMPLE_LEN);
+}
 
-   uart.disp(tmpC);
-   uart.disp("\n\r");
-
-   return tmpC;
+/** Turn off the RGB LEDs driven by temp_diff(). */
+void rgb_off(Pwm *pwm_p) {
+   pwm_p->set_duty(0, 0);
+   pwm_p->set_duty(0, 1);
+   pwm_p->set_duty(0, 2);
 }
 
 /**
- * Read the ADT7420 and display either Celsius or Fahrenheit based on switches.
+ * Display a temperature in either Celsius or Fahrenheit based on switch 0.
  */
-void adt7420_check(I2cCore *adt7420_p, GpoCore *led_p, SsegCore *sseg_t,
-                   GpiCore *sw_p) {
-   const uint8_t DEV_ADDR = 0x4b;
-   uint8_t wbytes[2], bytes[2];
-   uint16_t tmp;
-   float tmpC;
-   float tmpF;
+void temp_show(Temperature t, Sseg *sseg_t, Sw *sw_p) {
+   PROF_SCOPE("temp_show");
    int s;
    s = sw_p->read();
 
-   wbytes[0] = 0x0b;
-   adt7420_p->write_transaction(DEV_ADDR, wbytes, 1, 1);
-   adt7420_p->read_transaction(DEV_ADDR, bytes, 1, 0);
-
-   wbytes[0] = 0x00;
-   adt7420_p->write_transaction(DEV_ADDR, wbytes, 1, 1);
-   adt7420_p->read_transaction(DEV_ADDR, bytes, 2, 0);
-
-   tmp = (uint16_t)bytes[0];
-   tmp = (tmp << 8) + (uint16_t)bytes[1];
-   if (tmp & 0x8000) {
-      tmp = tmp >> 3;
-      tmpC = (float)((int)tmp - 8192) / 16;
-   } else {
-      tmp = tmp >> 3;
-      tmpC = (float)tmp / 16;
-   }
-   if (s == 1) {
-      tmpF = (tmpC * 9 / 5) + 32;
-      temp_disp_F(tmpF, sseg_t);
+   if (s & 0x01) {
+      temp_disp_F(t, sseg_t);
    } else {
-      temp_disp_C(tmpC, sseg_t);
+      temp_disp_C(t, sseg_t);
    }
 }
 
-/** Take multiple readings and return the average Celsius temperature. */
-float measure_avg_tmp() {
-   float total_tmp = 0;
-   float avg_tmp;
-   for (int j = 0; j < 30; j++) {
-      total_tmp += adt7420_read(&adt7420);
+/**
+ * One pass of the LIVE menu loop: poll buttons; samples are read on the
+ * bus in the background (sample_service()) and each new one is displayed
+ * as it completes. Bus waits are bounded by the i2c time-out, so a
+ * failing sensor does not stall the loop.
+ */
+void live_step(bool &RST_BTN, bool &LIVE_BTN, bool &Z_BTN) {
+   if (sample_new) {
+      sample_new = false;
+      // a failed read keeps the last good sample; LED 15 flags it stale
+      if (sw.read() & 0x10) {
+         // SW4: trend in C/min, colour coded as a difference
+         temp_diff(Temperature::from_q7(trend.slope()), &sseg, &pwm);
+         trend_shown = true;
+      } else {
+         temp_show(sample_temp, &sseg, &sw);
+         if (trend_shown) {
+            rgb_off(&pwm);
+            trend_shown = false;
+         }
+      }
+      led.write(adt7420.stale(), 15);
    }
-   avg_tmp = total_tmp / 30;
+   check_btn(&btn, &led, RST_BTN, LIVE_BTN, Z_BTN);
+}
 
-   uart.disp("\n\r");
-   uart.disp("total temp: ");
-   uart.disp(total_tmp);
-   uart.disp("\n\r");
-   uart.disp("avg_tmp: ");
-   uart.disp(avg_tmp);
-   uart.disp("\n\r");
-   sleep_ms(1000);
-   return avg_tmp;
+/** Show the fill level of the baseline window on LEDs 0-3. */
+void window_leds(Led *led_p) {
+   int lit = baseline_win.count() * 4 / TEMP_WINDOW_LEN;
+   for (int i = 0; i < 4; i++) {
+      led_p->write(i < lit, i);
+   }
 }
 
+/**
+ * Take the AVG baseline: O(1) snapshot of the background sample window.
+ * Returns the mean.
+ */
+Temperature baseline_capture() {
+   PROF_SCOPE("baseline_capture");
+   temp_window_t w;
 
-/** Simple sweep animation for LEDs. */
-void led_animation(GpoCore *led_p) {
-   for (int i = 0; i < 4; i++) {
-      led_p->write(1, i);
-      sleep_ms(100);
+   baseline_win.stats(&w);
+   if (tlm_bin) {
+      tlm_send(TLM_MODE_AVG, sample_raw, Temperature::from_q7(w.mean));
+   } else {
+      uart.printf("avg_tmp: %q7 (%d samples, variance %q14)\n\r",
+                  w.mean, w.count, (int32_t) w.var);
    }
+   return Temperature::from_q7(w.mean);
+}
+
+/** Timer callback: turn off the LEDs lit by led_animation_rst(). */
+void led_flash_off(void *arg) {
+   Led *led_p = (Led *) arg;
    for (int i = 3; i > -1; i--) {
       led_p->write(0, i);
-      sleep_ms(100);
    }
 }
 
-/** Full LED flash used during DIFF. */
-void led_animation_rst(GpoCore *led_p) {
+/**
+ * Full LED flash used during IDLE: LEDs on for 1 s (non-blocking).
+ * Returns the handle of the timer turning them off.
+ */
+int led_animation_rst(Led *led_p) {
    for (int i = 0; i < 4; i++) {
       led_p->write(1, i);
    }
-   sleep_ms(1000);
-   for (int i = 3; i > -1; i--) {
-      led_p->write(0, i);
+   return sys_wheel.start_once(1000, led_flash_off, led_p);
+}
+
+/** Timer callback: raise the flag pointed to by arg. */
+void set_flag(void *arg) {
+   *(bool *) arg = true;
+}
+
+/** Print min/max/mean of the last minute, hour and day, and the trend. */
+void history_report() {
+   static const uint32_t range_ms[3] = {60000, 3600000, 86400000};
+   static const char *name[3] = {"1m", "1h", "1d"};
+   uint32_t now = history.now();
+   hist_rec_t r;
+
+   for (int i = 0; i < 3; i++) {
+      uint32_t t0 = (now > range_ms[i]) ? now - range_ms[i] : 0;
+      if (history.query(t0, now, &r) == 0) {
+         uart.printf("history %s: none\n\r", name[i]);
+      } else {
+         uart.printf("history %s: min %q7 max %q7 mean %q7\n\r", name[i],
+                     r.min, r.max, r.mean);
+      }
+   }
+   uart.printf("trend: %q7 C/min over %d s\n\r", trend.slope(),
+               trend.count() * SAMPLE_MS / 1000);
+}
+
+/*
+ * Sample log dump as text (decoded by host/log_cat.cpp):
+ *    log <count> <nibbles> <res16> <period_ms> <dropped>
+ *    <nibble stream in hex, 32 bytes per line>
+ *    end
+ * sent one line per service() pass while the tx ring has room, so the
+ * sampler keeps running during the ~4 s a full log takes at 9600 baud
+ */
+#define LOG_LINE_BYTES 32
+uint32_t log_dump_pos = 0;   // next byte to send
+uint32_t log_dump_end = 0;   // bytes in the snapshot; 0: no dump running
+
+/** Start a log dump: header now, lines from log_dump_poll(). */
+void log_dump() {
+   if (log_dump_end != 0)
+      return;   // one dump at a time
+   uart.printf("log %u %u %d %d %u\n\r", sample_log.count(),
+               sample_log.nibbles(), sample_log.res16(), SAMPLE_MS,
+               sample_log.dropped());
+   // the log only grows: the bytes up to the snapshot stay as they are
+   log_dump_pos = 0;
+   log_dump_end = sample_log.bytes();
+   if (log_dump_end == 0)
+      uart.printf("end\n\r");
+}
+
+/** Send the next line of a running log dump if the tx ring has room. */
+void log_dump_poll() {
+   static const char hex[] = "0123456789abcdef";
+   const uint8_t *p = sample_log.data();
+   char line[2 * LOG_LINE_BYTES + 1];
+   int k = 0;
+
+   if (log_dump_end == 0)
+      return;
+   // room for a full line, its "\n\r" and the trailing "end\n\r"
+   if (UART_TX_BUF_SIZE - uart.tx_pending() < 2 * LOG_LINE_BYTES + 7)
+      return;
+   for (uint32_t j = log_dump_pos;
+        j < log_dump_end && j < log_dump_pos + LOG_LINE_BYTES; j++) {
+      line[k++] = hex[p[j] >> 4];
+      line[k++] = hex[p[j] & 0x0f];
+   }
+   line[k] = 0;
+   uart.printf("%s\n\r", line);
+   log_dump_pos += LOG_LINE_BYTES;
+   if (log_dump_pos >= log_dump_end) {
+      uart.printf("end\n\r");
+      log_dump_end = 0;
+   }
+}
+
+/**
+ * Filter type from switches 3-1: 0 none, 1 EMA, 2 boxcar, 3 median-3,
+ * 4 median-5 (others: none).
+ */
+int filter_sw(Sw *sw_p) {
+   return ((sw_p->read() >> 1) & 0x07);
+}
+
+// motion context: accelerometer FIFO drained once per sample period
+#define ACL_DRAIN_MAX 32    // samples per drain (100 Hz odr: 25 per period)
+#define ACL_MOTION_MG 100   // LED 14 threshold
+bool acl_ok = false;
+Adxl362Sample acl_last = {0, 0, 0};
+int acl_motion = 0;         // max change between samples of the last drain (mg)
+
+static inline int iabs(int v) {
+   return (v < 0) ? -v : v;
+}
+
+/**
+ * Drain the accelerometer FIFO; motion is the largest sample-to-sample
+ * change (|dx| + |dy| + |dz|) of the batch. LED 14 shows motion.
+ */
+void acl_service() {
+   PROF_SCOPE("acl_drain");
+   Adxl362Sample s[ACL_DRAIN_MAX];
+   int n, m = 0;
+
+   if (!acl_ok) {
+      return;
+   }
+   n = acl.drain(s, ACL_DRAIN_MAX);
+   for (int i = 0; i < n; i++) {
+      int d = iabs(s[i].x - acl_last.x) + iabs(s[i].y - acl_last.y)
+            + iabs(s[i].z - acl_last.z);
+      if (d > m) {
+         m = d;
+      }
+      acl_last = s[i];
+   }
+   if (n > 0) {
+      acl_motion = m;
+      led.write(m > ACL_MOTION_MG, 14);
+   }
+}
+
+/**
+ * Cross-check a sample against the die temperature (one bus access).
+ * A good sample updates the die offset; for a failed one (q7 is the
+ * last good sample) the die-based estimate is returned when known.
+ */
+int32_t die_backup(int rc, int32_t q7) {
+   int32_t die = xadc.read_temp_q7();
+
+   if (rc == 0) {
+      if (die_offset_ok) {
+         die_offset += (die - q7 - die_offset) >> DIE_OFFSET_SHIFT;
+      } else {
+         die_offset = die - q7;
+         die_offset_ok = true;
+      }
+      return q7;
+   }
+   return die_offset_ok ? die - die_offset : q7;
+}
+
+/** Print the sampling cadence statistics. */
+void sched_report() {
+   const SchedStats &st = sampler.stats();
+
+   uart.printf("sampler period %u ms samples %u missed %u overrun %u max late %u us\n\r",
+               sampler.period(), st.samples, st.missed, st.overruns,
+               st.max_late_us);
+   for (int k = 0; k < SCHED_HIST_BINS; k++) {
+      if (st.hist[k]) {
+         uart.printf("  late >= %u us: %u\n\r", SampleSched::bin_us(k),
+                     st.hist[k]);
+      }
+   }
+}
+
+/** Print the adaptive read rate and the resulting i2c bus load. */
+void rate_report() {
+   uint32_t ms = adapt.interval() * SAMPLE_MS;
+   uint32_t load = read_us * 10 / ms;   // 1/100 %
+
+   uart.printf("sensor read every %u ms (%u mHz), bus %u.%02u %%, band %q7\n\r",
+               ms, 1000000 / ms, load / 100, load % 100, adapt.band());
+}
+
+/**
+ * Hand a sample to the consumers. rc: 0 new sample, 1 failed read (raw is
+ * the last good sample), SAMPLE_HELD tick without a read (last sample
+ * repeated). A failed read is shown as the die-temperature estimate (see
+ * die_backup()) and kept out of the baseline window, which thus spans a
+ * fixed time. Only new samples drive the adaptive rate and go to the log,
+ * with the # ticks since the previous one. History and log take the
+ * unfiltered samples; the display and DIFF take the filtered ones.
+ */
+void sample_take(uint16_t raw, int rc) {
+   int32_t q7 = Temperature::from_raw(raw, adt7420.res16()).q7();
+
+   sample_raw = raw;
+   sample_new = true;
+   sample_seq++;
+   if (rc != SAMPLE_HELD) {
+      sample_in = die_backup(rc, q7);
+   }
+   sample_filt.select(filter_sw(&sw));
+   {
+      PROF_SCOPE("filter_step");
+      sample_temp = Temperature::from_q7(sample_filt.step(sample_in));
+   }
+   history.add(q7);
+   trend.add(sample_in);
+   log_gap++;
+   if (rc == 0) {
+      sample_log.append(raw, log_gap);   // counted as dropped once full
+      log_gap = 0;
+   }
+   if (rc == 1) {
+      adapt.kick();
+   } else {
+      baseline_win.add(q7);
+      if (rc == 0) {
+         adapt.update(q7);
+      }
+   }
+}
+
+/**
+ * Background sampling: collect the finished read; on each sampler tick
+ * start the next read or, when the adaptive policy skips this tick,
+ * repeat the last sample. A deadline hit while the previous read is still
+ * pending is counted as an overrun.
+ */
+void sample_service() {
+   uint16_t raw;
+   int rc;
+
+   rc = adt7420.read_busy() ? -1 : adt7420.read_result(&raw);
+   if (rc >= 0) {
+      uint32_t t = elapsed_ticks(read_t0);
+
+      PROF_RECORD("adt7420_read", t);
+      read_us = (uint32_t) ticks_to_us(t);
+      sample_take(raw, rc);
+   }
+   if (sampler.poll()) {
+      if (!adapt.due()) {
+         sample_take(sample_raw, SAMPLE_HELD);
+      } else if (adt7420.read_start() == 0) {
+         read_t0 = now_tick32();
+      } else {
+         sampler.overrun();
+      }
+      acl_service();
+   }
+}
+
+/** Background work; called on every pass of the menu loops. */
+void service() {
+   sys_wheel.advance();
+   uart.tx_drain();
+   i2c.poll();
+   sample_service();
+   log_dump_poll();
+   // console commands: 'b' binary telemetry, 't' text output,
+   // 'e' sensor error and display write counters, 'h' temperature history, 'l' log dump,
+   // 'a' acceleration, 'j' sampling jitter ('J' clears it),
+   // 'r' sensor read rate
+   int c = uart.rx_byte();
+   if (c == 'b') {
+      // a frame ends with 0x00 only: delimit the text sent so far,
+      // else the first record is decoded together with it
+      if (!tlm_bin)
+         uart.tx_byte(0);
+      tlm_bin = true;
+   } else if (c == 't') {
+      tlm_bin = false;
+   } else if (c == 'h') {
+      history_report();
+   } else if (c == 'a') {
+      uart.printf("acl x %d y %d z %d mg, motion %d mg\n\r",
+                  acl_last.x, acl_last.y, acl_last.z, acl_motion);
+   } else if (c == 'r') {
+      rate_report();
+   } else if (c == 'j') {
+      sched_report();
+   } else if (c == 'J') {
+      sampler.clear_stats();
+   } else if (c == 'l') {
+      log_dump();
+   } else if (c == 'e') {
+      const Adt7420Stats &e = adt7420.stats();
+      uart.printf("adt7420 reads %u nack %u timeout %u retry %u recover %u stale %u\n\r",
+                  e.reads, e.nack, e.timeout, e.retries, e.recoveries, e.stale);
+      uart.printf("xadc die %q7 vccint %d mV offset %q7\n\r",
+                  xadc.read_temp_q7(), xadc.read_vcc_mv(), die_offset);
+      const SsegStats &d = sseg.stats();
+      uart.printf("sseg frames %u writes %u saved %u (last %u)\n\r",
+                  d.frames, d.writes, d.saved, d.last_saved);
+   }
+#ifdef _PROFILE
+   // 'p' prints the profile, 'c' clears it
+   else if (c == 'p') {
+      prof_dump();
+   } else if (c == 'c') {
+      prof_clear();
+   }
+#endif
+}
+
+int idle_tmr = -1;   // IDLE LED flash timer
+
+/** Stop the IDLE LED flash when another menu is entered. */
+void idle_exit() {
+   if (sys_wheel.active(idle_tmr)) {
+      sys_wheel.cancel(idle_tmr);
+      led_flash_off(&led);
    }
 }
 
@@ -335,84 +715,133 @@ int main() {
    bool Z_BTN = false;
    bool AVG_BTN = false;
    bool DIFF_BTN = false;
-   float saved_tmp;
-
+   bool avg_wait = false;    // AVG pressed; window not yet full
+   Temperature saved_tmp;
+
+   pwm.init();
+   sseg.init();
+   // console output queued and sent from service()
+   uart.set_tx_policy(UartCore::TX_BLOCK);
+   // sensor id checked once
+   adt7420.init();
+   uart.printf("read ADT7420 id (should be 0xcb): %x\n\r", adt7420.id());
+   // fastest i2c clock the sensor follows reliably (fast mode at most)
+   uart.printf("i2c clock: %d Hz\n\r",
+               i2c.select_speed(Adt7420::DEV_ADDR, Adt7420::MAX_FREQ));
+   sample_log.clear(adt7420.res16());
+   acl_ok = (acl.init() == 0);
+   uart.printf("adxl362: %s\n\r", acl_ok ? "ok" : "not found");
+   sampler.start();
    while (1) {
+      service();
       Interface currentState = check_btn(&btn, &led, RST_BTN, LIVE_BTN, Z_BTN);
       switch (currentState) {
-         case Interface::IDLE:
-            disp_RST(&sseg);
-            led_animation_rst(&led);
-            sseg_clear(&sseg);
-            saved_tmp = 0;
+         case Interface::IDLE: {
+            PROF_SCOPE("state_idle");
+            // "RST" with LEDs flashing: restarted when the 1 s flash ends
+            if (!sys_wheel.active(idle_tmr)) {
+               sseg_clear(&sseg);
+               disp_RST(&sseg);
+               idle_tmr = led_animation_rst(&led);
+            }
+            saved_tmp = Temperature();
             DIFF_BTN = 0;
-            led.write(0, 0);
-            led.write(0, 1);
-            led.write(0, 2);
-            led.write(0, 3);
+            avg_wait = false;
             check_btn(&btn, &led, RST_BTN, LIVE_BTN, Z_BTN);
             break;
+         }
 
-         case Interface::LIVE:
+         case Interface::LIVE: {
+            idle_exit();
             sseg_clear(&sseg);
             disp_LIVE(&sseg);
-            sleep_ms(2000);
+            // banner shown for 2 s; buttons still polled meanwhile
+            bool banner_done = false;
+            int banner_tmr = sys_wheel.start_once(2000, set_flag, &banner_done);
             while (LIVE_BTN == 1) {
-               adt7420_check(&adt7420, &led, &sseg, &sw);
-               check_btn(&btn, &led, RST_BTN, LIVE_BTN, Z_BTN);
+               PROF_SCOPE("state_live");
+               service();
+               if (banner_done) {
+                  live_step(RST_BTN, LIVE_BTN, Z_BTN);
+               } else {
+                  check_btn(&btn, &led, RST_BTN, LIVE_BTN, Z_BTN);
+               }
                if (LIVE_BTN == 0) {
                   sseg_clear(&sseg);
                   break;
                }
             }
+            sys_wheel.cancel(banner_tmr);
             break;
+         }
 
          case Interface::DIFF:
+            idle_exit();
             disp_AVG(&sseg);
             while (Z_BTN == 1) {
+               PROF_SCOPE("state_diff");
+               service();
                check_btn_r(&btn, AVG_BTN, DIFF_BTN);
                if (AVG_BTN) {
                   sseg_clear(&sseg);
                   disp_AVG(&sseg);
-                  led_animation(&led);
-                  sleep_ms(1000);
-                  sseg_clear(&sseg);
-
-                  float tmp = measure_avg_tmp();
-                  temp_disp_C(tmp, &sseg);
-                  saved_tmp = tmp;
-
-                  sleep_ms(500);
+                  avg_wait = true;
                   AVG_BTN = false;
                }
+               // baseline taken as soon as the window is full;
+               // LEDs 0-3 show the fill level until then
+               if (avg_wait) {
+                  window_leds(&led);
+                  if (baseline_win.full()) {
+                     avg_wait = false;
+                     led_flash_off(&led);
+                     sseg_clear(&sseg);
+                     saved_tmp = baseline_capture();
+                     temp_disp_C(saved_tmp, &sseg);
+                  }
+               }
 
                if (DIFF_BTN) {
                   sseg_clear(&sseg);
                   disp_DIFF(&sseg);
-                  sleep_ms(2000);
-                  sseg_clear(&sseg);
-               }
-               while (DIFF_BTN) {
-                  float current = adt7420_read(&adt7420);
-                  float difference = saved_tmp - current;
-                  uart.disp("stored : ");
-                  uart.disp(saved_tmp);
-                  uart.disp("\n\r");
-                  uart.disp("current : ");
-                  uart.disp(current);
-                  uart.disp("\n\r");
-                  uart.disp("difference : ");
-                  uart.disp(difference);
-                  uart.disp("\n\r");
-                  temp_diff(difference, &sseg, &pwm);
-                  sleep_ms(500);
-                  check_btn(&btn, &led, RST_BTN, LIVE_BTN, Z_BTN);
-                  if (RST_BTN == 1 || LIVE_BTN == 1) {
-                     pwm.set_duty(0, 0);
-                     pwm.set_duty(0, 1);
-                     pwm.set_duty(0, 2);
-                     DIFF_BTN = false;
+                  // "DIFF" banner for 2 s, then the latest filtered
+                  // sample every DIFF_SAMPLES samples
+                  bool banner_done = false;
+                  bool banner = true;
+                  uint32_t diff_seq = 0;
+                  int diff_tmr = sys_wheel.start_once(2000, set_flag, &banner_done);
+                  while (DIFF_BTN) {
+                     service();
+                     if (banner && banner_done) {
+                        sseg_clear(&sseg);
+                        banner = false;
+                        diff_seq = sample_seq - DIFF_SAMPLES;
+                     }
+                     if (!banner && sample_seq - diff_seq >= DIFF_SAMPLES) {
+                        diff_seq = sample_seq;
+                        Temperature current = sample_temp;
+                        Temperature difference = saved_tmp - current;
+                        if (tlm_bin) {
+                           tlm_send(TLM_MODE_DIFF, sample_raw, saved_tmp);
+                        } else {
+                           // a failed read repeats the last good sample
+                           uart.printf("%q7%s\n\r", current.q7(),
+                                       adt7420.stale() ? " (stale)" : "");
+                           uart.printf("stored : %q7\n\r"
+                                       "current : %q7\n\r"
+                                       "difference : %q7\n\r",
+                                       saved_tmp.q7(), current.q7(),
+                                       difference.q7());
+                        }
+                        temp_diff(difference, &sseg, &pwm);
+                     }
+                     check_btn(&btn, &led, RST_BTN, LIVE_BTN, Z_BTN);
+                     if (RST_BTN == 1 || LIVE_BTN == 1) {
+                        rgb_off(&pwm);
+                        DIFF_BTN = false;
+                     }
                   }
+                  sys_wheel.cancel(diff_tmr);
                }
 
                check_btn(&btn, &led, RST_BTN, LIVE_BTN, Z_BTN);
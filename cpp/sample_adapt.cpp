@@ -0,0 +1,63 @@
+/*****************************************************************//**
+ * @file sample_adapt.cpp
+ *
+ * @brief implementation of SampleAdapt class
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include "sample_adapt.h"
+
+SampleAdapt::SampleAdapt(int32_t band_q7, int max_shift, int stable_n) {
+   this->band_q7 = band_q7;
+   this->max_shift = max_shift;
+   this->stable_n = stable_n;
+   ref = 0;
+   ref_ok = 0;
+   kick();
+}
+
+SampleAdapt::~SampleAdapt() {
+}
+
+int SampleAdapt::due() {
+   if (++cnt < (1 << shift))
+      return (0);
+   cnt = 0;
+   return (1);
+}
+
+void SampleAdapt::update(int32_t q7) {
+   int32_t d = q7 - ref;
+
+   if (ref_ok && d <= band_q7 && d >= -band_q7) {
+      if (++stable >= stable_n && shift < max_shift) {
+         shift++;
+         stable = 0;
+      }
+      return;
+   }
+   // change: new reference, fastest rate
+   ref = q7;
+   ref_ok = 1;
+   shift = 0;
+   stable = 0;
+}
+
+void SampleAdapt::kick() {
+   shift = 0;
+   stable = 0;
+   cnt = 0;   // due() on the next tick
+}
+
+int SampleAdapt::interval() {
+   return (1 << shift);
+}
+
+int32_t SampleAdapt::band() {
+   return (band_q7);
+}
+
+void SampleAdapt::set_band(int32_t q7) {
+   band_q7 = q7;
+}
@@ -0,0 +1,89 @@
+/*****************************************************************//**
+ * @file sample_adapt.h
+ *
+ * @brief adaptive sensor read interval on a fixed sample grid
+ *
+ * Detailed description:
+ *  - the sample grid (SampleSched) keeps its period; this policy
+ *    decides on which grid ticks the sensor is actually read; the
+ *    other ticks repeat the last sample
+ *  - read interval doubles (1, 2, 4, ... grid ticks, up to
+ *    2^max_shift) after stable_n successive reads within +/-band of
+ *    the reference reading
+ *  - a reading outside the band, a failed read or kick() (e.g., a
+ *    button event) returns to reading every tick
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#ifndef _SAMPLE_ADAPT_H_INCLUDED
+#define _SAMPLE_ADAPT_H_INCLUDED
+
+#include <inttypes.h>
+
+#ifndef ADAPT_BAND_Q7
+#define ADAPT_BAND_Q7 16        // stable band: +/-0.125 C
+#endif
+#ifndef ADAPT_MAX_SHIFT
+#define ADAPT_MAX_SHIFT 4       // longest interval: 16 grid ticks
+#endif
+#ifndef ADAPT_STABLE_N
+#define ADAPT_STABLE_N 4        // stable reads before doubling
+#endif
+
+/**
+ * adaptive read policy
+ *
+ */
+class SampleAdapt {
+public:
+   /**
+    * constructor.
+    * @param band_q7 stable band in 1/128 C
+    * @param max_shift longest interval 2^max_shift ticks
+    * @param stable_n # stable reads before the interval doubles
+    */
+   SampleAdapt(int32_t band_q7 = ADAPT_BAND_Q7, int max_shift = ADAPT_MAX_SHIFT,
+               int stable_n = ADAPT_STABLE_N);
+   ~SampleAdapt();               // not used
+
+   /**
+    * called once per grid tick
+    * @return 1 if the sensor is read on this tick
+    */
+   int due();
+
+   /**
+    * feed a good reading
+    * @param q7 temperature in 1/128 C
+    */
+   void update(int32_t q7);
+
+   /**
+    * back to reading every tick (from the next tick on)
+    */
+   void kick();
+
+   /**
+    * current read interval in grid ticks
+    */
+   int interval();
+
+   /**
+    * stable band in 1/128 C
+    */
+   int32_t band();
+   void set_band(int32_t q7);
+
+private:
+   int32_t band_q7;
+   int max_shift;
+   int stable_n;
+   int shift;            // interval = 2^shift ticks
+   int cnt;              // ticks since the last read
+   int stable;           // successive stable reads at this interval
+   int ref_ok;
+   int32_t ref;          // reading the band is centered on
+};
+
+#endif  // _SAMPLE_ADAPT_H_INCLUDED
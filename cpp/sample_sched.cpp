@@ -0,0 +1,87 @@
+/*****************************************************************//**
+ * @file sample_sched.cpp
+ *
+ * @brief implementation of SampleSched class
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include "sample_sched.h"
+
+SampleSched::SampleSched(uint32_t period_ms) {
+   running = 0;
+   next = 0;
+   period_t = 0;
+   set_period(period_ms);
+   clear_stats();
+}
+
+SampleSched::~SampleSched() {
+}
+
+void SampleSched::start() {
+   next = now_tick32() + period_t;
+   running = 1;
+}
+
+void SampleSched::set_period(uint32_t period_ms) {
+   uint32_t old = period_t;
+
+   this->period_ms = period_ms;
+   period_t = (uint32_t) ms_to_ticks(period_ms);
+   // pending deadline moved to one new period after the last one
+   if (running)
+      next = next - old + period_t;
+}
+
+uint32_t SampleSched::period() {
+   return (period_ms);
+}
+
+void SampleSched::clear_stats() {
+   st.samples = 0;
+   st.missed = 0;
+   st.overruns = 0;
+   st.max_late_us = 0;
+   for (int i = 0; i < SCHED_HIST_BINS; i++)
+      st.hist[i] = 0;
+}
+
+void SampleSched::overrun() {
+   st.overruns++;
+}
+
+// lateness of a served deadline into the histogram
+void SampleSched::record(uint32_t late) {
+   uint32_t us = (uint32_t) ticks_to_us(late);
+   int k = 0;
+
+   while (us && k < SCHED_HIST_BINS - 1) {
+      us >>= 1;
+      k++;
+   }
+   st.hist[k]++;
+   us = (uint32_t) ticks_to_us(late);
+   if (us > st.max_late_us)
+      st.max_late_us = us;
+}
+
+int SampleSched::poll() {
+   uint32_t late, skip;
+
+   if (!running)
+      return (0);
+   late = now_tick32() - next;
+   if ((int32_t) late < 0)
+      return (0);
+   // whole periods passed: those deadlines are lost
+   skip = late / period_t;
+   if (skip) {
+      st.missed += skip;
+      late -= skip * period_t;
+   }
+   next += (skip + 1) * period_t;
+   st.samples++;
+   record(late);
+   return (1);
+}
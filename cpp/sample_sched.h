@@ -0,0 +1,108 @@
+/*****************************************************************//**
+ * @file sample_sched.h
+ *
+ * @brief fixed-rate sample scheduler with jitter statistics
+ *
+ * Detailed description:
+ *  - deadlines on an absolute grid: deadline n = start + n * period,
+ *    so a late poll does not shift the following samples (no drift)
+ *  - poll() from the main loop: one 32-bit timer read per call
+ *  - lateness (poll time - deadline) recorded in a log2 histogram:
+ *    bin 0 < 1 us, bin k in [2^(k-1), 2^k) us, last bin open-ended
+ *  - deadlines passed entirely (lateness >= 1 period) are counted as
+ *    missed and skipped; the grid is kept
+ *  - overrun: counted by the consumer when a due sample cannot be
+ *    taken (e.g., the previous one still in progress)
+ *  - period below TICK32_SPAN / 2
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#ifndef _SAMPLE_SCHED_H_INCLUDED
+#define _SAMPLE_SCHED_H_INCLUDED
+
+#include "chu_init.h"
+
+#ifndef SCHED_HIST_BINS
+#define SCHED_HIST_BINS 16      // lateness bins (last: >= 2^14 us)
+#endif
+
+/**
+ * scheduler statistics
+ */
+struct SchedStats {
+   uint32_t samples;     // # deadlines served
+   uint32_t missed;      // # deadlines skipped
+   uint32_t overruns;    // # due samples not taken (see overrun())
+   uint32_t max_late_us; // largest lateness of a served deadline
+   uint32_t hist[SCHED_HIST_BINS];   // lateness histogram
+};
+
+/**
+ * periodic sample scheduler
+ *
+ */
+class SampleSched {
+public:
+   /**
+    * constructor.
+    * @param period_ms sample period
+    * @note no timer access until start()
+    */
+   SampleSched(uint32_t period_ms);
+   ~SampleSched();               // not used
+
+   /**
+    * start the grid: first deadline one period from now
+    */
+   void start();
+
+   /**
+    * change the period; takes effect from the next deadline
+    * @param period_ms new period
+    */
+   void set_period(uint32_t period_ms);
+
+   /**
+    * current period (ms)
+    */
+   uint32_t period();
+
+   /**
+    * check the deadline
+    * @return 1 if a sample is due (once per deadline); 0 otherwise
+    */
+   int poll();
+
+   /**
+    * count a due sample that could not be taken
+    */
+   void overrun();
+
+   /**
+    * statistics since start/clear
+    */
+   const SchedStats &stats() {
+      return (st);
+   }
+
+   void clear_stats();
+
+   /**
+    * lower bound (us) of a histogram bin
+    */
+   static uint32_t bin_us(int k) {
+      return ((k == 0) ? 0 : (uint32_t) 1 << (k - 1));
+   }
+
+private:
+   uint32_t period_ms;
+   uint32_t period_t;    // period in ticks
+   uint32_t next;        // next deadline (tick32)
+   int running;
+   SchedStats st;
+
+   void record(uint32_t late);
+};
+
+#endif  // _SAMPLE_SCHED_H_INCLUDED
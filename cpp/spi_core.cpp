@@ -0,0 +1,83 @@
+/*****************************************************************//**
+ * @file spi_core.cpp
+ *
+ * @brief implementation of SpiCore class
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include "spi_core.h"
+
+SpiCore::SpiCore(uint32_t core_base_addr) {
+   base_addr = core_base_addr;
+   ss_n_data = 0xffffffff;
+   ctrl = 0;
+   write_ss_n(ss_n_data);
+   set_freq(400000);
+   set_mode(0, 0);
+}
+SpiCore::~SpiCore() {
+}
+
+int SpiCore::set_freq(int freq) {
+   uint32_t half;
+
+   if (freq <= 0)
+      return (-1);
+   // half sclk period in sys clocks, rounded up; dvsr = half - 1
+   half = (uint32_t) (((uint64_t) SYS_CLK_FREQ * 1000000 + 2 * (uint64_t) freq - 1)
+         / (2 * (uint64_t) freq));
+   if (half < 1 || half > DVSR_MAX + 1)
+      return (-1);
+   ctrl = (ctrl & ~(uint32_t) DVSR_MAX) | (half - 1);
+   io_write(base_addr, CTRL_REG, ctrl);
+   return ((int) (SYS_CLK_FREQ * 1000000 / (2 * half)));
+}
+
+void SpiCore::set_mode(int icpol, int icpha) {
+   ctrl &= ~(uint32_t) (CPOL_FIELD | CPHA_FIELD);
+   if (icpol)
+      ctrl |= CPOL_FIELD;
+   if (icpha)
+      ctrl |= CPHA_FIELD;
+   io_write(base_addr, CTRL_REG, ctrl);
+}
+
+void SpiCore::write_ss_n(uint32_t data) {
+   ss_n_data = data;
+   io_write(base_addr, SS_REG, ss_n_data);
+}
+
+void SpiCore::assert_ss(int n) {
+   write_ss_n(ss_n_data & ~((uint32_t) 1 << n));
+}
+
+void SpiCore::deassert_ss(int n) {
+   write_ss_n(ss_n_data | ((uint32_t) 1 << n));
+}
+
+uint8_t SpiCore::transfer(uint8_t wr_data) {
+   return (xfer(wr_data));
+}
+
+void SpiCore::transfer(int n, const uint8_t *wr, uint8_t *rd, int num) {
+   uint8_t b;
+
+   assert_ss(n);
+   for (int i = 0; i < num; i++) {
+      b = xfer(wr ? wr[i] : 0x00);
+      if (rd)
+         rd[i] = b;
+   }
+   deassert_ss(n);
+}
+
+void SpiCore::read_burst(int n, const uint8_t *cmd, int cmd_num, uint8_t *rd,
+                         int num) {
+   assert_ss(n);
+   for (int i = 0; i < cmd_num; i++)
+      xfer(cmd[i]);
+   for (int i = 0; i < num; i++)
+      rd[i] = xfer(0x00);
+   deassert_ss(n);
+}
@@ -0,0 +1,129 @@
+/*****************************************************************//**
+ * @file spi_core.h
+ *
+ * @brief SPI master core driver
+ *
+ * Detailed description:
+ *  - one byte per transfer; sclk period = 2 * (dvsr + 1) clocks
+ *  - mode set by cpol/cpha of the control register
+ *  - slave selects driven by the ss_n register (active low)
+ *  - status and received byte in one register: a single read per
+ *    poll of a byte in flight
+ *  - burst transfers: n bytes under one slave-select assertion
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#ifndef _SPI_CORE_H_INCLUDED
+#define _SPI_CORE_H_INCLUDED
+
+#include "chu_init.h"
+
+/**
+ * SPI master core driver
+ *
+ */
+class SpiCore {
+public:
+   /**
+    * register map
+    *
+    */
+   enum {
+      READ_DATA_REG = 0,   /**< ready (bit 8) and received byte */
+      SS_REG = 1,          /**< slave select (active low) */
+      WRITE_DATA_REG = 2,  /**< write starts a transfer */
+      CTRL_REG = 3         /**< dvsr (bits 15-0), cpol (16), cpha (17) */
+   };
+   /**
+    * field masks
+    *
+    */
+   enum {
+      READY_FIELD = 0x00000100,
+      RX_DATA_FIELD = 0x000000ff,
+      CPOL_FIELD = 0x00010000,
+      CPHA_FIELD = 0x00020000,
+      DVSR_MAX = 0xffff
+   };
+   /**
+    * constructor.
+    *
+    */
+   SpiCore(uint32_t core_base_addr);
+   ~SpiCore();                   // not used
+
+   /* methods */
+   /**
+    * set sclk frequency
+    * @param freq sclk frequency (Hz)
+    * @return achieved frequency (not above freq); -1 if out of range
+    */
+   int set_freq(int freq);
+
+   /**
+    * set spi mode
+    * @param icpol clock polarity
+    * @param icpha clock phase
+    */
+   void set_mode(int icpol, int icpha);
+
+   /**
+    * write the slave select register
+    * @param data ss_n pattern (bit i low selects slave i)
+    */
+   void write_ss_n(uint32_t data);
+
+   /**
+    * select/deselect a slave
+    * @param n slave #
+    */
+   void assert_ss(int n);
+   void deassert_ss(int n);
+
+   /**
+    * transfer one byte (slave select unchanged)
+    * @param wr_data byte sent
+    * @return byte received
+    */
+   uint8_t transfer(uint8_t wr_data);
+
+   /**
+    * burst transfer with one slave-select assertion
+    * @param n slave #
+    * @param wr bytes sent (0: 0x00 sent)
+    * @param rd bytes received (0: discarded)
+    * @param num # bytes
+    */
+   void transfer(int n, const uint8_t *wr, uint8_t *rd, int num);
+
+   /**
+    * command/read burst: the command bytes, then num bytes read
+    * (0x00 sent), one slave-select assertion
+    * @param n slave #
+    * @param cmd command bytes
+    * @param cmd_num # command bytes
+    * @param rd bytes received after the command
+    * @param num # bytes read
+    */
+   void read_burst(int n, const uint8_t *cmd, int cmd_num, uint8_t *rd,
+                   int num);
+
+private:
+   uint32_t base_addr;
+   uint32_t ss_n_data;
+   uint32_t ctrl;
+
+   // issue a byte; wait for it (ready polled with one read per pass)
+   uint8_t xfer(uint8_t wr_data) {
+      uint32_t rd;
+
+      io_write(base_addr, WRITE_DATA_REG, wr_data);
+      do {
+         rd = io_read(base_addr, READ_DATA_REG);
+      } while (!(rd & READY_FIELD));
+      return ((uint8_t) (rd & RX_DATA_FIELD));
+   }
+};
+
+#endif  // _SPI_CORE_H_INCLUDED
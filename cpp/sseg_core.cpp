@@ -14,6 +14,10 @@ SsegCore::SsegCore(uint32_t core_base_addr) {
    // i.e., HI_PTN[0] is the leftmost led
    const uint8_t HI_PTN[]={0xff,0xf9,0x89,0xff,0xff,0xff,0xff,0xff};
    base_addr = core_base_addr;
+   reg_ok = false;
+   frame = false;
+   staged = 0;
+   clear_stats();
    write_8ptn((uint8_t*) HI_PTN);
    set_dp(0x02);
 }
@@ -23,30 +27,61 @@ SsegCore::~SsegCore() {
 // not used
 
 void SsegCore::write_led() {
+   staged++;
+   if (!frame)
+      commit();
+}
+
+void SsegCore::begin() {
+   frame = true;
+}
+
+void SsegCore::commit() {
+   uint32_t word[2];
+   uint32_t n = 0;
+
+   // ptn_buf[3..0] and dp bits 3..0 form the low word;
+   // ptn_buf[7..4] and dp bits 7..4 form the high word
+   word[0] = pack_word(&ptn_buf[0], dp);
+   word[1] = pack_word(&ptn_buf[4], dp >> 4);
+   for (int i = 0; i < 2; i++) {
+      if (!reg_ok || word[i] != reg[i]) {
+         io_write(base_addr, DATA_LOW_REG + i, word[i]);
+         reg[i] = word[i];
+         n++;
+      }
+   }
+   reg_ok = true;
+   // unframed, each staged call would have written both words
+   st.frames++;
+   st.writes += n;
+   st.last_saved = (2 * staged > (int) n) ? 2 * staged - n : 0;
+   st.saved += st.last_saved;
+   staged = 0;
+   frame = false;
+}
+
+void SsegCore::clear_stats() {
+   st.frames = 0;
+   st.writes = 0;
+   st.saved = 0;
+   st.last_saved = 0;
+}
+
+uint32_t SsegCore::pack_word(const uint8_t *ptn, uint8_t dp_bits) {
    int i, p;
    uint32_t word = 0;
 
-   // pack left 4 patterns into a 32-bit word
-   // ptn_buf[0] is the leftmost led
+   // pack 4 patterns into a 32-bit word
    for (i = 0; i < 4; i++) {
-      word = (word << 8) | ptn_buf[3 - i];
+      word = (word << 8) | ptn[3 - i];
    }
    // incorporate decimal points (bit 7 of pattern)
    for (i = 0; i < 4; i++) {
-      p = bit_read(dp, i);
-      bit_write(word, 7 + 8 * i, p);
-   }
-   io_write(base_addr, DATA_LOW_REG, word);
-   // pack right 4 patterns into a 32-bit word
-   for (i = 0; i < 4; i++) {
-      word = (word << 8) | ptn_buf[7 - i];
-   }
-   // incorporate decimal points
-   for (i = 0; i < 4; i++) {
-      p = bit_read(dp, 4 + i);
+      p = bit_read(dp_bits, i);
       bit_write(word, 7 + 8 * i, p);
    }
-   io_write(base_addr, DATA_HIGH_REG, word);
+   return (word);
 }
 
 void SsegCore::write_8ptn(uint8_t *ptn_array) {
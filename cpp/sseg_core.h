@@ -12,12 +12,27 @@
 
 #include "chu_init.h"
 
+/**
+ * display write counters
+ */
+struct SsegStats {
+   uint32_t frames;      // # commits (an unframed write is one frame)
+   uint32_t writes;      // # register writes
+   uint32_t saved;       // # register writes avoided
+   uint32_t last_saved;  // # register writes avoided by the last frame
+};
+
 /**
  * seven-segment LED core driver
  *  - control 8/4-digit seven-segment LED display.
  *  - an 8-element buffer (ptn_buf[]) stores the 8 7-seg patterns.
  *  - dp stores the decimal point pattern
- *  - the 7-seg pattern and dp combined in write_led()
+ *  - the 7-seg pattern and dp combined in commit()
+ *  - frame: between begin() and commit(), write_1ptn(), write_8ptn()
+ *    and set_dp() only stage into the buffer; commit() packs the two
+ *    register words once; outside a frame each call commits at once
+ *  - a register write is skipped when its word is unchanged; "saved"
+ *    counts the writes avoided against two per call
  *  - will work for 4-digit 7-seg display (ignoring upper 4 digits)
  *  - if modified for an 8-by-8 LED matrix, dp portion should be removed
  */
@@ -45,7 +60,7 @@ public:
     * @return 7-seg pattern w/ MSB equal to 1
     * @note return 0xff if hex exceeds 15
     */
-   uint8_t h2s(int hex);
+   static uint8_t h2s(int hex);
 
    /**
     * write one 7-seg pattern to a specific position
@@ -70,14 +85,157 @@ public:
     */
    void set_dp(uint8_t pt);
 
+   /**
+    * pack 4 7-seg patterns and their decimal points into a register word
+    * @param ptn pointer to 4 patterns (ptn[0] goes to bits 7..0)
+    * @param dp_bits active-low decimal points in bits 3..0
+    * @return 32-bit data for DATA_LOW_REG/DATA_HIGH_REG
+    */
+   static uint32_t pack_word(const uint8_t *ptn, uint8_t dp_bits);
+
+   /**
+    * start a frame: writes are staged until commit()
+    */
+   void begin();
+
+   /**
+    * end a frame: write the changed register words
+    */
+   void commit();
+
+   /**
+    * write counters
+    */
+   const SsegStats &stats() {
+      return (st);
+   }
+
+   /**
+    * clear the write counters
+    */
+   void clear_stats();
+
 private:
    /* variable to keep track of current status */
    uint32_t base_addr;
    uint8_t ptn_buf[8];    // led pattern buffer
    uint8_t dp;            // decimal point
+   uint32_t reg[2];       // last words written to DATA_LOW/HIGH_REG
+   bool reg_ok;           // reg[] valid
+   bool frame;            // inside begin()/commit()
+   int staged;            // # calls staged in the frame
+   SsegStats st;
    /* methods */
-   void write_led();      // write patterns to reg
+   void write_led();      // stage a call; commit unless in a frame
 }
 ;
 
-#endif  // _SSEG_CORE_H_INCLUDED
\ No newline at end of file
+/**
+ * seven-segment LED core driver bound to slot SLOT at compile time
+ *  - e.g., slot::SsegCore<S8_SSEG>
+ *  - register addresses are compile-time constants
+ *  - constexpr constructor does not touch the hardware;
+ *    init() blanks the display and shows "HI."
+ *  - same methods as ::SsegCore
+ */
+namespace slot {
+
+template<int SLOT>
+class SsegCore {
+public:
+   enum {
+      DATA_LOW_REG = ::SsegCore::DATA_LOW_REG,
+      DATA_HIGH_REG = ::SsegCore::DATA_HIGH_REG
+   };
+   static constexpr uint32_t base_addr = get_slot_addr(BRIDGE_BASE, SLOT);
+
+   constexpr SsegCore() :
+         ptn_buf { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff }, dp(0xff),
+         reg { 0, 0 }, reg_ok(false), frame(false), staged(0),
+         st { 0, 0, 0, 0 } {
+   }
+
+   void init() {
+      const uint8_t HI_PTN[] = {0xff,0xf9,0x89,0xff,0xff,0xff,0xff,0xff};
+      write_8ptn((uint8_t*) HI_PTN);
+      set_dp(0x02);
+   }
+
+   uint8_t h2s(int hex) {
+      return (::SsegCore::h2s(hex));
+   }
+
+   void write_1ptn(uint8_t pattern, int pos) {
+      ptn_buf[pos] = pattern;
+      write_led();
+   }
+
+   void write_8ptn(uint8_t *ptn_array) {
+      for (int i = 0; i < 8; i++)
+         ptn_buf[i] = ptn_array[i];
+      write_led();
+   }
+
+   void set_dp(uint8_t pt) {
+      dp = ~pt;     // active low
+      write_led();
+   }
+
+   void begin() {
+      frame = true;
+   }
+
+   void commit() {
+      uint32_t low = ::SsegCore::pack_word(&ptn_buf[0], dp);
+      uint32_t high = ::SsegCore::pack_word(&ptn_buf[4], dp >> 4);
+      uint32_t n = 0;
+
+      if (!reg_ok || low != reg[0]) {
+         io_write(base_addr, DATA_LOW_REG, low);
+         reg[0] = low;
+         n++;
+      }
+      if (!reg_ok || high != reg[1]) {
+         io_write(base_addr, DATA_HIGH_REG, high);
+         reg[1] = high;
+         n++;
+      }
+      reg_ok = true;
+      st.frames++;
+      st.writes += n;
+      st.last_saved = (2 * staged > (int) n) ? 2 * staged - n : 0;
+      st.saved += st.last_saved;
+      staged = 0;
+      frame = false;
+   }
+
+   const SsegStats &stats() {
+      return (st);
+   }
+
+   void clear_stats() {
+      st.frames = 0;
+      st.writes = 0;
+      st.saved = 0;
+      st.last_saved = 0;
+   }
+
+private:
+   uint8_t ptn_buf[8];    // led pattern buffer
+   uint8_t dp;            // decimal point
+   uint32_t reg[2];       // last words written
+   bool reg_ok;           // reg[] valid
+   bool frame;            // inside begin()/commit()
+   int staged;            // # calls staged in the frame
+   SsegStats st;
+
+   void write_led() {
+      staged++;
+      if (!frame)
+         commit();
+   }
+};
+
+} // namespace slot
+
+#endif  // _SSEG_CORE_H_INCLUDED
@@ -0,0 +1,118 @@
+/*****************************************************************//**
+ * @file telemetry.h
+ *
+ * @brief binary telemetry record of the thermometer
+ *
+ * Description:
+ *  - one record per temperature sample, sent as a COBS frame
+ *    (see chu_cobs.h) by UartCore::tx_frame()
+ *  - payload (12 bytes; raw register big-endian as read from the
+ *    sensor, other multi-byte fields little-endian):
+ *      byte 0       : type (bits 7..4) | flags (bit 3) | mode (bits 2..0)
+ *      bytes 1..4   : time stamp, system clock ticks >> TLM_TS_SHIFT
+ *      bytes 5..6   : raw ADT7420 temperature register (msb:lsb);
+ *                     the last good one while reads fail
+ *      bytes 7..8   : baseline temperature, signed, 1/128 C
+ *      bytes 9..10  : temperature shown (filtered; from the die
+ *                     temperature while reads fail), signed, 1/128 C
+ *      byte 11      : status, TLM_STAT_xxx
+ *  - on the wire: 12 payload + 2 crc (big-endian) + 1 cobs
+ *    + 1 delimiter = 16 bytes
+ *  - 'b' sends a 0x00 first, ending the text output before the
+ *    first frame
+ *  - header only; shared by firmware and host decoder
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#ifndef _TELEMETRY_H_INCLUDED
+#define _TELEMETRY_H_INCLUDED
+
+#include <inttypes.h>
+
+#define TLM_TYPE_SAMPLE 0x1
+#define TLM_SAMPLE_LEN 12
+#define TLM_TS_SHIFT 10        // 10.24 us per time stamp unit @100 MHz
+#define TLM_FLAG_16BIT 0x08    // raw register in 16-bit resolution
+#define TLM_STAT_STALE 0x01    // latest read failed; raw is the last good one
+#define TLM_STAT_BACKUP 0x02   // shown temperature from the die sensor
+
+/**
+ * operating mode carried in a record
+ */
+enum {
+   TLM_MODE_IDLE = 0,
+   TLM_MODE_LIVE = 1,
+   TLM_MODE_AVG = 2,
+   TLM_MODE_DIFF = 3
+};
+
+/**
+ * decoded sample record
+ */
+typedef struct {
+   uint8_t mode;        // TLM_MODE_xxx
+   uint8_t res16;       // 1: raw in 16-bit resolution; 0: 13-bit
+   uint32_t ts;         // time stamp (ticks >> TLM_TS_SHIFT)
+   uint16_t raw;        // temperature register as read
+   int16_t baseline;    // baseline in 1/128 C
+   int16_t temp;        // temperature shown in 1/128 C
+   uint8_t status;      // TLM_STAT_xxx
+} tlm_sample_t;
+
+/**
+ * pack a sample record
+ * @param s record
+ * @param buf output of at least TLM_SAMPLE_LEN bytes
+ * @return # payload bytes
+ */
+static inline int tlm_pack(const tlm_sample_t *s, uint8_t *buf) {
+   buf[0] = (uint8_t) ((TLM_TYPE_SAMPLE << 4) | (s->res16 ? TLM_FLAG_16BIT : 0)
+         | (s->mode & 0x07));
+   buf[1] = (uint8_t) s->ts;
+   buf[2] = (uint8_t) (s->ts >> 8);
+   buf[3] = (uint8_t) (s->ts >> 16);
+   buf[4] = (uint8_t) (s->ts >> 24);
+   buf[5] = (uint8_t) (s->raw >> 8);
+   buf[6] = (uint8_t) s->raw;
+   buf[7] = (uint8_t) s->baseline;
+   buf[8] = (uint8_t) ((uint16_t) s->baseline >> 8);
+   buf[9] = (uint8_t) s->temp;
+   buf[10] = (uint8_t) ((uint16_t) s->temp >> 8);
+   buf[11] = s->status;
+   return (TLM_SAMPLE_LEN);
+}
+
+/**
+ * unpack a sample record
+ * @param buf payload
+ * @param n # payload bytes
+ * @param s decoded record
+ * @return 0: ok; -1: not a sample record
+ */
+static inline int tlm_unpack(const uint8_t *buf, int n, tlm_sample_t *s) {
+   if (n != TLM_SAMPLE_LEN || (buf[0] >> 4) != TLM_TYPE_SAMPLE)
+      return (-1);
+   s->mode = buf[0] & 0x07;
+   s->res16 = (buf[0] & TLM_FLAG_16BIT) ? 1 : 0;
+   s->ts = (uint32_t) buf[1] | ((uint32_t) buf[2] << 8)
+         | ((uint32_t) buf[3] << 16) | ((uint32_t) buf[4] << 24);
+   s->raw = (uint16_t) ((buf[5] << 8) | buf[6]);
+   s->baseline = (int16_t) (buf[7] | (buf[8] << 8));
+   s->temp = (int16_t) (buf[9] | (buf[10] << 8));
+   s->status = buf[11];
+   return (0);
+}
+
+/**
+ * temperature of a raw register value in 1/128 C
+ * @param raw temperature register
+ * @param res16 1: 16-bit resolution; 0: 13-bit (3 flag bits)
+ */
+static inline int32_t tlm_raw_q7(uint16_t raw, int res16) {
+   if (res16)
+      return ((int32_t) (int16_t) raw);
+   return ((int32_t) ((int16_t) (raw & 0xfff8)));   // 13-bit code << 3
+}
+
+#endif  // _TELEMETRY_H_INCLUDED
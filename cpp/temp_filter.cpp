@@ -0,0 +1,125 @@
+/*****************************************************************//**
+ * @file temp_filter.cpp
+ *
+ * @brief implementation of TempFilter class
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include "temp_filter.h"
+
+// compare-exchange: a <= b afterwards
+#define CMP_XCHG(a, b) do { \
+      int32_t _t = (a); \
+      if (_t > (b)) { (a) = (b); (b) = _t; } \
+   } while (0)
+
+TempFilter::TempFilter(int type) {
+   ftype = FILT_NONE;
+   select(type);
+   reset();
+}
+
+TempFilter::~TempFilter() {
+}
+
+void TempFilter::select(int type) {
+   if (type < 0 || type >= FILT_NUM)
+      type = FILT_NONE;
+   if (type != ftype) {
+      ftype = type;
+      reset();
+   }
+}
+
+int TempFilter::type() {
+   return (ftype);
+}
+
+void TempFilter::reset() {
+   num = 0;
+   ema = 0;
+   box_pos = 0;
+   box_sum = 0;
+   med_pos = 0;
+}
+
+const char *TempFilter::name(int type) {
+   static const char *names[FILT_NUM] = {
+      "none", "ema", "box", "med3", "med5"
+   };
+
+   if (type < 0 || type >= FILT_NUM)
+      return ("?");
+   return (names[type]);
+}
+
+// median of 3: 3 compare-exchanges
+static int32_t median3(int32_t a, int32_t b, int32_t c) {
+   CMP_XCHG(a, b);
+   CMP_XCHG(b, c);
+   CMP_XCHG(a, b);
+   return (b);
+}
+
+// median of 5: 9-comparator sorting network, middle element
+static int32_t median5(const int16_t *v) {
+   int32_t a = v[0], b = v[1], c = v[2], d = v[3], e = v[4];
+
+   CMP_XCHG(a, b);
+   CMP_XCHG(d, e);
+   CMP_XCHG(c, e);
+   CMP_XCHG(c, d);
+   CMP_XCHG(a, d);
+   CMP_XCHG(a, c);
+   CMP_XCHG(b, e);
+   CMP_XCHG(b, d);
+   CMP_XCHG(b, c);
+   return (c);
+}
+
+int32_t TempFilter::step(int32_t q7) {
+   const int32_t half = 1 << (FILTER_EMA_SHIFT - 1);
+   int32_t y;
+
+   if (num < FILTER_BOX_LEN + 5)
+      num++;
+   switch (ftype) {
+   case FILT_EMA:
+      // ema = y * 2^S; y += (x - y) / 2^S, rounded so that a
+      // constant input converges exactly
+      if (num == 1)
+         ema = q7 << FILTER_EMA_SHIFT;
+      else
+         ema += q7 - ((ema + half) >> FILTER_EMA_SHIFT);
+      return ((ema + half) >> FILTER_EMA_SHIFT);
+   case FILT_BOX:
+      if (num > FILTER_BOX_LEN)
+         box_sum -= box[box_pos];
+      box[box_pos] = (int16_t) q7;
+      box_sum += q7;
+      box_pos = (box_pos + 1) % FILTER_BOX_LEN;
+      if (num < FILTER_BOX_LEN)
+         return (q7);
+      // round half up; / power of 2 becomes a shift
+      y = box_sum + FILTER_BOX_LEN / 2;
+      return ((y >= 0) ? y / FILTER_BOX_LEN
+            : -((-y + FILTER_BOX_LEN - 1) / FILTER_BOX_LEN));
+   case FILT_MED3:
+   case FILT_MED5:
+      med[med_pos] = (int16_t) q7;
+      med_pos = (med_pos == 4) ? 0 : med_pos + 1;
+      if (ftype == FILT_MED3) {
+         if (num < 3)
+            return (q7);
+         // med_pos is the oldest of 5; the last 3 follow it
+         return (median3(med[(med_pos + 2) % 5], med[(med_pos + 3) % 5],
+               med[(med_pos + 4) % 5]));
+      }
+      if (num < 5)
+         return (q7);
+      return (median5(med));
+   default:
+      return (q7);
+   }
+}
@@ -0,0 +1,96 @@
+/*****************************************************************//**
+ * @file temp_filter.h
+ *
+ * @brief integer filters of the temperature sample stream
+ *
+ * Detailed description:
+ *  - samples in 1/128 C; integer arithmetic only
+ *  - FILT_EMA : exponential moving average, alpha = 2^-FILTER_EMA_SHIFT
+ *  - FILT_BOX : moving average of FILTER_BOX_LEN samples (running sum)
+ *  - FILT_MED3/FILT_MED5: median of the last 3/5 samples by a
+ *    compare-exchange network (no data-dependent loops)
+ *  - constant cost per sample; type selectable at run time
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#ifndef _TEMP_FILTER_H_INCLUDED
+#define _TEMP_FILTER_H_INCLUDED
+
+#include <inttypes.h>
+
+#ifndef FILTER_EMA_SHIFT
+#define FILTER_EMA_SHIFT 3      // alpha = 1/8
+#endif
+#ifndef FILTER_BOX_LEN
+#define FILTER_BOX_LEN 8        // boxcar length (power of 2 preferred)
+#endif
+
+/**
+ * filter types
+ */
+enum {
+   FILT_NONE = 0,
+   FILT_EMA = 1,
+   FILT_BOX = 2,
+   FILT_MED3 = 3,
+   FILT_MED5 = 4,
+   FILT_NUM = 5
+};
+
+/**
+ * sample filter
+ *  - output equals the input until a boxcar or median window has
+ *    been filled after a reset
+ *
+ */
+class TempFilter {
+public:
+   /**
+    * constructor.
+    * @param type FILT_xxx
+    */
+   TempFilter(int type = FILT_NONE);
+   ~TempFilter();                // not used
+
+   /**
+    * select the filter type
+    * @param type FILT_xxx; unknown types select FILT_NONE
+    * @note state reset only when the type changes
+    */
+   void select(int type);
+
+   /**
+    * current filter type
+    */
+   int type();
+
+   /**
+    * discard the filter history
+    */
+   void reset();
+
+   /**
+    * filter one sample
+    * @param q7 sample in 1/128 C
+    * @return filtered sample in 1/128 C
+    */
+   int32_t step(int32_t q7);
+
+   /**
+    * name of a filter type (e.g., for the console)
+    */
+   static const char *name(int type);
+
+private:
+   int ftype;
+   int num;                        // # samples since reset (saturated)
+   int32_t ema;                    // EMA state, 1/128 C << FILTER_EMA_SHIFT
+   int16_t box[FILTER_BOX_LEN];
+   int box_pos;
+   int32_t box_sum;
+   int16_t med[5];                 // last 5 samples
+   int med_pos;
+};
+
+#endif  // _TEMP_FILTER_H_INCLUDED
@@ -0,0 +1,159 @@
+/*****************************************************************//**
+ * @file temp_history.cpp
+ *
+ * @brief implementation of TempHistory class
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include "temp_history.h"
+#include "temperature.h"
+
+static const uint32_t tier_len[HIST_TIERS] = {
+   HIST_RAW_LEN, HIST_MIN_LEN, HIST_HOUR_LEN
+};
+
+TempHistory::TempHistory(uint32_t sample_ms) {
+   per_min = 60000 / sample_ms;
+   period[HIST_RAW] = sample_ms;
+   period[HIST_MIN] = 60000;
+   period[HIST_HOUR] = 3600000;
+   clear();
+}
+
+TempHistory::~TempHistory() {
+}
+
+void TempHistory::clear() {
+   int i;
+
+   for (i = 0; i < HIST_TIERS; i++)
+      num[i] = 0;
+   for (i = 0; i < HIST_TIERS - 1; i++)
+      acc[i].n = 0;
+}
+
+// fold a record of the tier below into the open aggregate of tier
+void TempHistory::acc_add(int tier, int32_t lo, int32_t hi, int32_t mean) {
+   Acc *a = &acc[tier - 1];
+
+   if (a->n == 0) {
+      a->lo = lo;
+      a->hi = hi;
+      a->sum = 0;
+   } else {
+      if (lo < a->lo)
+         a->lo = lo;
+      if (hi > a->hi)
+         a->hi = hi;
+   }
+   a->sum += mean;
+   a->n++;
+   if (a->n == ((tier == HIST_MIN) ? per_min : 60))
+      push(tier);
+}
+
+// close the open aggregate of tier; roll it into the next tier
+void TempHistory::push(int tier) {
+   Acc *a = &acc[tier - 1];
+   uint32_t i = num[tier] % tier_len[tier];
+   int32_t mean = Temperature::rdiv(a->sum, (int32_t) a->n);
+
+   if (tier == HIST_MIN) {
+      min_lo[i] = (int16_t) a->lo;
+      min_hi[i] = (int16_t) a->hi;
+      min_mean[i] = (int16_t) mean;
+   } else {
+      hr_lo[i] = (int16_t) a->lo;
+      hr_hi[i] = (int16_t) a->hi;
+      hr_mean[i] = (int16_t) mean;
+   }
+   num[tier]++;
+   a->n = 0;
+   if (tier + 1 < HIST_TIERS)
+      acc_add(tier + 1, a->lo, a->hi, mean);
+}
+
+void TempHistory::add(int32_t q7) {
+   raw[num[HIST_RAW] % HIST_RAW_LEN] = (int16_t) q7;
+   num[HIST_RAW]++;
+   acc_add(HIST_MIN, q7, q7, q7);
+}
+
+uint32_t TempHistory::now() {
+   return (num[HIST_RAW] * period[HIST_RAW]);
+}
+
+int TempHistory::length(int tier) {
+   if (tier < 0 || tier >= HIST_TIERS)
+      return (0);
+   return ((int) (num[tier] < tier_len[tier] ? num[tier] : tier_len[tier]));
+}
+
+int TempHistory::get(int tier, int k, hist_rec_t *r) {
+   uint32_t j, i;
+
+   if (k < 0 || k >= length(tier))
+      return (-1);
+   j = num[tier] - 1 - (uint32_t) k;   // absolute record #
+   i = j % tier_len[tier];
+   r->t = j * period[tier];
+   r->span = period[tier];
+   if (tier == HIST_RAW) {
+      r->min = raw[i];
+      r->max = raw[i];
+      r->mean = raw[i];
+   } else if (tier == HIST_MIN) {
+      r->min = min_lo[i];
+      r->max = min_hi[i];
+      r->mean = min_mean[i];
+   } else {
+      r->min = hr_lo[i];
+      r->max = hr_hi[i];
+      r->mean = hr_mean[i];
+   }
+   return (0);
+}
+
+int TempHistory::query(uint32_t t0, uint32_t t1, hist_rec_t *r) {
+   hist_rec_t rec;
+   uint32_t first, start;
+   int tier, k, used;
+   int32_t sum;
+
+   // finest tier whose oldest record starts at or before t0
+   for (tier = 0; tier < HIST_TIERS - 1; tier++) {
+      first = num[tier] - (uint32_t) length(tier);
+      if (first * period[tier] <= t0)
+         break;
+   }
+   used = 0;
+   sum = 0;
+   start = 0;
+   // newest to oldest; stop once records end before t0
+   for (k = 0; get(tier, k, &rec) == 0; k++) {
+      if (rec.t + rec.span <= t0)
+         break;
+      if (rec.t >= t1)
+         continue;
+      if (used == 0) {
+         r->min = rec.min;
+         r->max = rec.max;
+         r->span = rec.t + rec.span;   // end time for now
+      } else {
+         if (rec.min < r->min)
+            r->min = rec.min;
+         if (rec.max > r->max)
+            r->max = rec.max;
+      }
+      start = rec.t;
+      sum += rec.mean;
+      used++;
+   }
+   if (used == 0)
+      return (0);
+   r->mean = (int16_t) Temperature::rdiv(sum, used);
+   r->t = start;
+   r->span = r->span - start;
+   return (used);
+}
@@ -0,0 +1,132 @@
+/*****************************************************************//**
+ * @file temp_history.h
+ *
+ * @brief tiered temperature history
+ *
+ * Detailed description:
+ *  - three tiers of fixed-capacity ring buffers:
+ *      HIST_RAW : samples at the sensor rate
+ *      HIST_MIN : 1-minute min/max/mean
+ *      HIST_HOUR: 1-hour min/max/mean
+ *  - each tier rolls into the next incrementally: O(1) per sample
+ *  - struct-of-arrays of 16-bit codes (1/128 C); no time stamps
+ *    stored, the time of a record follows from its index
+ *  - default sizes: 4 min of raw samples @250 ms, 4 h of minutes and
+ *    2 days of hours in 3.6K bytes of static storage
+ *  - time in ms since the first sample
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#ifndef _TEMP_HISTORY_H_INCLUDED
+#define _TEMP_HISTORY_H_INCLUDED
+
+#include <inttypes.h>
+
+#ifndef HIST_RAW_LEN
+#define HIST_RAW_LEN 960        // # raw samples kept
+#endif
+#ifndef HIST_MIN_LEN
+#define HIST_MIN_LEN 240        // # 1-minute records kept
+#endif
+#ifndef HIST_HOUR_LEN
+#define HIST_HOUR_LEN 48        // # 1-hour records kept
+#endif
+
+/**
+ * history tiers
+ */
+enum {
+   HIST_RAW = 0,
+   HIST_MIN = 1,
+   HIST_HOUR = 2,
+   HIST_TIERS = 3
+};
+
+/**
+ * history record / query result
+ */
+typedef struct {
+   uint32_t t;          // start time (ms)
+   uint32_t span;       // covered time (ms)
+   int16_t min;         // 1/128 C
+   int16_t max;
+   int16_t mean;
+} hist_rec_t;
+
+/**
+ * tiered history store
+ *  - add() must be called once per sample period; a missed sample
+ *    should be filled in (e.g., with the last good value) to keep
+ *    the time base
+ *
+ */
+class TempHistory {
+public:
+   /**
+    * constructor.
+    * @param sample_ms sample period; must divide 60000
+    */
+   TempHistory(uint32_t sample_ms);
+   ~TempHistory();               // not used
+
+   /**
+    * discard all records
+    */
+   void clear();
+
+   /**
+    * add a sample
+    * @param q7 temperature in 1/128 C
+    */
+   void add(int32_t q7);
+
+   /**
+    * time at the end of the latest sample (ms)
+    */
+   uint32_t now();
+
+   /**
+    * # records kept in a tier
+    * @param tier HIST_xxx
+    */
+   int length(int tier);
+
+   /**
+    * read a record
+    * @param tier HIST_xxx
+    * @param k age (0: newest complete record)
+    * @param r record
+    * @return 0: ok; -1: no such record
+    */
+   int get(int tier, int k, hist_rec_t *r);
+
+   /**
+    * min/max/mean over a time range
+    * @param t0 start (ms, inclusive)
+    * @param t1 end (ms, exclusive)
+    * @param r result; r->t/r->span give the range actually covered
+    * @return # records used (0: none in range)
+    * @note the finest tier still holding t0 is used; records
+    *       partly inside the range are included
+    */
+   int query(uint32_t t0, uint32_t t1, hist_rec_t *r);
+
+private:
+   // struct of arrays; raw tier holds one value per record
+   int16_t raw[HIST_RAW_LEN];
+   int16_t min_lo[HIST_MIN_LEN], min_hi[HIST_MIN_LEN], min_mean[HIST_MIN_LEN];
+   int16_t hr_lo[HIST_HOUR_LEN], hr_hi[HIST_HOUR_LEN], hr_mean[HIST_HOUR_LEN];
+   uint32_t period[HIST_TIERS];   // record period (ms)
+   uint32_t num[HIST_TIERS];      // # records ever completed
+   uint32_t per_min;              // # samples per minute
+   // open aggregates of the minute and hour tiers
+   struct Acc {
+      int32_t lo, hi, sum;
+      uint32_t n;
+   } acc[HIST_TIERS - 1];
+   void acc_add(int tier, int32_t lo, int32_t hi, int32_t mean);
+   void push(int tier);
+};
+
+#endif  // _TEMP_HISTORY_H_INCLUDED
@@ -0,0 +1,237 @@
+/*****************************************************************//**
+ * @file temp_log.cpp
+ *
+ * @brief implementation of TempLog and TempLogReader classes
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include "temp_log.h"
+
+// raw register <-> sensor code
+static int32_t raw_to_code(uint16_t raw, int res16) {
+   return (res16 ? (int32_t) (int16_t) raw : (int32_t) ((int16_t) raw >> 3));
+}
+
+static uint16_t code_to_raw(int32_t code, int res16) {
+   return (res16 ? (uint16_t) code : (uint16_t) (code << 3));
+}
+
+// # nibbles of a variable-length value
+static int var_len(uint32_t z) {
+   int n = 1;
+
+   while (z >= 8) {
+      z >>= 3;
+      n++;
+   }
+   return (n);
+}
+
+/**********************************************************************
+ * TempLogReader
+ *********************************************************************/
+TempLogReader::TempLogReader(const uint8_t *buf, uint32_t nibbles,
+                             uint32_t count, int res16) {
+   this->buf = buf;
+   this->nibbles = nibbles;
+   this->count = count;
+   this->res16 = res16;
+   start(0, 0);
+}
+
+void TempLogReader::start(uint32_t nib, uint32_t idx, uint32_t tick) {
+   pos = nib;
+   this->idx = idx;
+   code = 0;
+   t = tick;
+}
+
+// read a variable-length value of at most max nibbles; -1 if corrupt
+int TempLogReader::get_var(uint32_t *v, int max) {
+   uint32_t z = 0;
+   int i, n;
+
+   for (i = 0; ; i++) {
+      if (i == max || pos >= nibbles)
+         return (-1);
+      n = nibble();
+      pos++;
+      z |= (uint32_t) (n & 0x07) << (3 * i);
+      if (!(n & 0x08))
+         break;
+   }
+   *v = z;
+   return (0);
+}
+
+int TempLogReader::next(uint16_t *raw) {
+   uint32_t z, gap;
+   int i;
+
+   if (idx >= count)
+      return (0);
+   gap = 0;
+   if (idx % LOG_KEY_INTERVAL == 0) {
+      // keyframe: absolute 16-bit code, gap - 1
+      if (pos + LOG_KEY_NIBBLES > nibbles)
+         return (-1);
+      z = 0;
+      for (i = 0; i < LOG_KEY_NIBBLES; i++) {
+         z |= (uint32_t) nibble() << (4 * i);
+         pos++;
+      }
+      code = (int16_t) z;
+      if (get_var(&gap, LOG_GAP_NIBBLES_MAX) != 0)
+         return (-1);
+   } else {
+      if (get_var(&z, LOG_DELTA_NIBBLES_MAX) != 0)
+         return (-1);
+      if ((z & 1) && get_var(&gap, LOG_GAP_NIBBLES_MAX) != 0)
+         return (-1);
+      z >>= 1;
+      // zigzag: 0, -1, 1, -2, ... <- 0, 1, 2, 3, ...
+      code += (int32_t) (z >> 1) ^ -(int32_t) (z & 1);
+   }
+   t += gap + 1;
+   idx++;
+   *raw = code_to_raw(code, res16);
+   return (1);
+}
+
+/**********************************************************************
+ * TempLog
+ *********************************************************************/
+TempLog::TempLog(int res16) {
+   clear(res16);
+}
+
+TempLog::~TempLog() {
+}
+
+void TempLog::clear(int res16) {
+   num = 0;
+   pos = 0;
+   t = 0;
+   drop = 0;
+   last = 0;
+   res = res16;
+}
+
+void TempLog::put(uint32_t v) {
+   uint8_t *p = &buf[pos >> 1];
+
+   if (pos & 1)
+      *p = (uint8_t) ((*p & 0x0f) | (v << 4));
+   else
+      *p = (uint8_t) (v & 0x0f);
+   pos++;
+}
+
+// n: # nibbles of v (var_len(v))
+void TempLog::put_var(uint32_t v, int n) {
+   int i;
+
+   for (i = 0; i < n; i++)
+      put(((v >> (3 * i)) & 0x07) | ((i < n - 1) ? 0x08 : 0));
+}
+
+int TempLog::append(uint16_t raw, uint32_t gap) {
+   int32_t code = raw_to_code(raw, res);
+   uint32_t z, g;
+   int i, n, ng;
+
+   g = (gap > 0) ? gap - 1 : 0;
+   ng = var_len(g);
+   if (num % LOG_KEY_INTERVAL == 0) {
+      if (num / LOG_KEY_INTERVAL >= LOG_KEYS_MAX
+            || pos + LOG_KEY_NIBBLES + ng > LOG_NIBBLES) {
+         drop++;
+         return (-1);
+      }
+      key[num / LOG_KEY_INTERVAL] = pos;
+      key_tick[num / LOG_KEY_INTERVAL] = t;
+      z = (uint16_t) code;
+      for (i = 0; i < LOG_KEY_NIBBLES; i++)
+         put((z >> (4 * i)) & 0x0f);
+      put_var(g, ng);
+   } else {
+      int32_t d = code - last;
+      z = ((uint32_t) d << 1) ^ (uint32_t) (d >> 31);   // zigzag
+      z = (z << 1) | (g != 0);                          // gap flag
+      n = var_len(z);
+      if (g == 0)
+         ng = 0;
+      if (pos + n + ng > LOG_NIBBLES) {
+         drop++;
+         return (-1);
+      }
+      put_var(z, n);
+      put_var(g, ng);
+   }
+   last = code;
+   t += g + 1;
+   num++;
+   return (0);
+}
+
+TempLogReader TempLog::reader(uint32_t k) {
+   TempLogReader r(buf, pos, num, res);
+
+   if (k < num)
+      r.start(key[k / LOG_KEY_INTERVAL], k - k % LOG_KEY_INTERVAL,
+              key_tick[k / LOG_KEY_INTERVAL]);
+   return (r);
+}
+
+int TempLog::get(uint32_t k, uint16_t *raw) {
+   TempLogReader r = reader(k);
+
+   if (k >= num)
+      return (-1);
+   while (r.index() <= k) {
+      if (r.next(raw) != 1)
+         return (-1);
+   }
+   return (0);
+}
+
+uint32_t TempLog::count() {
+   return (num);
+}
+
+uint32_t TempLog::dropped() {
+   return (drop);
+}
+
+uint32_t TempLog::bytes() {
+   return ((pos + 1) / 2);
+}
+
+uint32_t TempLog::remaining() {
+   uint32_t left = LOG_NIBBLES - pos;
+
+   // nothing logged yet: one nibble per delta assumed
+   if (num < 2)
+      return (capacity(left / 2, 1));
+   return ((uint32_t) ((uint64_t) left * num / pos));
+}
+
+uint32_t TempLog::capacity(uint32_t bytes, uint32_t delta_nibbles) {
+   // one block: a keyframe with its gap and LOG_KEY_INTERVAL - 1 deltas
+   uint32_t blk = LOG_KEY_NIBBLES + 1 + (LOG_KEY_INTERVAL - 1) * delta_nibbles;
+
+   return ((uint32_t) ((uint64_t) 2 * bytes * LOG_KEY_INTERVAL / blk));
+}
+
+int TempLog::res16() {
+   return (res);
+}
+
+const uint8_t *TempLog::data() {
+   return (buf);
+}
+
+uint32_t TempLog::nibbles() {
+   return (pos);
+}
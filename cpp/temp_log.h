@@ -0,0 +1,219 @@
+/*****************************************************************//**
+ * @file temp_log.h
+ *
+ * @brief delta-compressed append-only log of ADT7420 samples
+ *
+ * Detailed description:
+ *  - samples kept as sensor codes (raw register >> 3 in 13-bit mode;
+ *    the 3 flag bits are not stored), each with its distance in
+ *    sampler ticks ("gap") to the previous one, so ticks without a
+ *    new read take no space
+ *  - nibble stream, low nibble of a byte first; variable-length
+ *    values ("var") 3 bits per nibble, LSB first, bit 3 set when
+ *    another nibble follows
+ *  - every LOG_KEY_INTERVAL samples a keyframe: absolute 16-bit code
+ *    in 4 nibbles, then var(gap - 1); its nibble offset and tick kept
+ *    in an index for random access
+ *  - other samples: var(zigzag delta to the previous code << 1 | g),
+ *    g = 1 when gap > 1, then var(gap - 1) if g is set
+ *      |delta| <= 1 LSB, gap 1  : 1 nibble
+ *      |delta| <= 15 LSB, gap 1 : 2 nibbles
+ *  - ~0.5-1 byte per sample for a slowly changing temperature
+ *  - log full: further samples are dropped (append() returns -1)
+ *    and counted (dropped())
+ *  - TempLogReader decodes a nibble stream (the live log or a dump
+ *    read back on the host, see host/log_cat.cpp)
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#ifndef _TEMP_LOG_H_INCLUDED
+#define _TEMP_LOG_H_INCLUDED
+
+#include <inttypes.h>
+
+#ifndef LOG_BYTES
+#define LOG_BYTES 2048          // nibble stream storage
+#endif
+#ifndef LOG_KEY_INTERVAL
+#define LOG_KEY_INTERVAL 64     // # samples per keyframe
+#endif
+
+/**
+ * log constants
+ */
+enum {
+   LOG_NIBBLES = 2 * LOG_BYTES,
+   LOG_KEY_NIBBLES = 4,        // code of a keyframe (gap follows)
+   LOG_DELTA_NIBBLES_MAX = 6,  // 17-bit zigzag delta + gap flag
+   LOG_GAP_NIBBLES_MAX = 11,   // 32-bit gap
+   // a block takes at least 4 + 1 + (LOG_KEY_INTERVAL - 1) nibbles
+   LOG_KEYS_MAX = LOG_NIBBLES / (LOG_KEY_NIBBLES + LOG_KEY_INTERVAL) + 1
+};
+
+/**
+ * streaming decoder of a log nibble stream
+ *  - sequential: next() per sample; tick() its sampler tick
+ *  - start() positions at a keyframe (see TempLog::reader())
+ *
+ */
+class TempLogReader {
+public:
+   /**
+    * constructor.
+    * @param buf nibble stream
+    * @param nibbles # valid nibbles in buf
+    * @param count # samples in buf
+    * @param res16 1: 16-bit codes; 0: 13-bit
+    */
+   TempLogReader(const uint8_t *buf, uint32_t nibbles, uint32_t count,
+                 int res16);
+
+   /**
+    * position at a keyframe
+    * @param nib nibble offset of the keyframe
+    * @param idx index of its sample (multiple of LOG_KEY_INTERVAL)
+    * @param tick tick of the sample before it (0 at the start)
+    */
+   void start(uint32_t nib, uint32_t idx, uint32_t tick = 0);
+
+   /**
+    * decode the next sample
+    * @param raw sample as raw ADT7420 register (flag bits 0)
+    * @return 1 if a sample was decoded; 0 at the end; -1 if the
+    *         stream is corrupt
+    */
+   int next(uint16_t *raw);
+
+   /**
+    * index of the next sample
+    */
+   uint32_t index() {
+      return (idx);
+   }
+
+   /**
+    * sampler tick of the last decoded sample (sum of the gaps)
+    */
+   uint32_t tick() {
+      return (t);
+   }
+
+private:
+   const uint8_t *buf;
+   uint32_t nibbles;
+   uint32_t count;
+   int res16;
+   uint32_t pos;        // nibble offset of the next sample
+   uint32_t idx;        // index of the next sample
+   int32_t code;        // last code
+   uint32_t t;          // tick of the last sample
+
+   int nibble() {
+      return ((buf[pos >> 1] >> ((pos & 1) << 2)) & 0x0f);
+   }
+   int get_var(uint32_t *v, int max);
+};
+
+/**
+ * append-only sample log
+ *
+ */
+class TempLog {
+public:
+   /**
+    * constructor.
+    * @param res16 1: 16-bit raw codes; 0: 13-bit
+    */
+   TempLog(int res16 = 0);
+   ~TempLog();                   // not used
+
+   /**
+    * discard all samples
+    * @param res16 resolution of subsequent samples
+    */
+   void clear(int res16);
+
+   /**
+    * append a sample (streaming encode)
+    * @param raw raw ADT7420 temperature register
+    * @param gap # sampler ticks since the previous sample (>= 1)
+    * @return 0 if appended; -1 if the log is full (sample dropped)
+    */
+   int append(uint16_t raw, uint32_t gap = 1);
+
+   /**
+    * random access: decodes from the nearest keyframe;
+    * O(LOG_KEY_INTERVAL)
+    * @param k sample index
+    * @param raw sample
+    * @return 0 if ok; -1 if k out of range
+    */
+   int get(uint32_t k, uint16_t *raw);
+
+   /**
+    * reader positioned at sample k (0 if out of range)
+    * @param k sample index
+    */
+   TempLogReader reader(uint32_t k = 0);
+
+   /**
+    * # samples in the log
+    */
+   uint32_t count();
+
+   /**
+    * # samples dropped since the log filled up
+    */
+   uint32_t dropped();
+
+   /**
+    * # bytes in use
+    */
+   uint32_t bytes();
+
+   /**
+    * remaining capacity estimate in samples, at the average
+    * nibbles/sample (keyframes included) so far
+    */
+   uint32_t remaining();
+
+   /**
+    * capacity estimate
+    * @param bytes storage
+    * @param delta_nibbles average nibbles per delta (1 or 2 are typical)
+    * @return # samples that fit
+    */
+   static uint32_t capacity(uint32_t bytes, uint32_t delta_nibbles);
+
+   /**
+    * resolution of the logged samples
+    */
+   int res16();
+
+   /**
+    * nibble stream (e.g., for a dump)
+    */
+   const uint8_t *data();
+
+   /**
+    * # nibbles in use
+    */
+   uint32_t nibbles();
+
+private:
+   uint8_t buf[LOG_BYTES];
+   uint32_t key[LOG_KEYS_MAX];     // nibble offset of each keyframe
+   uint32_t key_tick[LOG_KEYS_MAX];  // tick before each keyframe
+   uint32_t num;                   // # samples
+   uint32_t pos;                   // # nibbles in use
+   uint32_t t;                     // tick of the last sample
+   uint32_t drop;                  // # samples dropped
+   int32_t last;                   // last code
+   int res;
+
+   void put(uint32_t v);
+   void put_var(uint32_t v, int n);
+};
+
+#endif  // _TEMP_LOG_H_INCLUDED
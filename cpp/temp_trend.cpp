@@ -0,0 +1,88 @@
+/*****************************************************************//**
+ * @file temp_trend.cpp
+ *
+ * @brief implementation of TempTrend class
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include "temp_trend.h"
+
+TempTrend::TempTrend(uint32_t sample_ms) {
+   per_min = 60000 / sample_ms;
+   clear();
+}
+
+TempTrend::~TempTrend() {
+}
+
+void TempTrend::clear() {
+   head = 0;
+   num = 0;
+   t_next = 0;
+   s_t = 0;
+   s_x = 0;
+   s_tx = 0;
+   s_tt = 0;
+}
+
+void TempTrend::add(int32_t q7) {
+   int64_t t = t_next;
+
+   if (num == TREND_LEN)
+      evict();
+   buf[head] = (int16_t) q7;
+   head = (head + 1) % TREND_LEN;
+   num++;
+   s_t += t;
+   s_x += q7;
+   s_tx += t * q7;
+   s_tt += t * t;
+   t_next++;
+   if (t_next >= TREND_REBASE)
+      rebase();
+}
+
+void TempTrend::evict() {
+   int64_t t;
+   int32_t x;
+
+   if (num == 0)
+      return;
+   t = t_next - num;
+   x = buf[(head - num + TREND_LEN) % TREND_LEN];
+   num--;
+   s_t -= t;
+   s_x -= x;
+   s_tx -= t * x;
+   s_tt -= t * t;
+}
+
+// t' = t - d with d the index of the oldest sample:
+// Stt' = Stt - 2d St + n d^2; Stx' = Stx - d Sx; St' = St - n d
+void TempTrend::rebase() {
+   int64_t d = t_next - num;
+
+   s_tt -= 2 * d * s_t - (int64_t) num * d * d;
+   s_tx -= d * s_x;
+   s_t -= (int64_t) num * d;
+   t_next = num;
+}
+
+int TempTrend::count() {
+   return (num);
+}
+
+int32_t TempTrend::slope() {
+   int64_t n = num, q, r;
+
+   if (num < 2)
+      return (0);
+   // per sample: (n Stx - St Sx) / (n Stt - St^2); scaled to per minute
+   q = (n * s_tx - s_t * s_x) * per_min;
+   r = n * s_tt - s_t * s_t;
+   // round half away from zero (r > 0)
+   if (q >= 0)
+      return ((int32_t) ((q + r / 2) / r));
+   return ((int32_t) -((-q + r / 2) / r));
+}
@@ -0,0 +1,82 @@
+/*****************************************************************//**
+ * @file temp_trend.h
+ *
+ * @brief rate of change of temperature by sliding-window regression
+ *
+ * Detailed description:
+ *  - least-squares slope over the last TREND_LEN samples taken at a
+ *    fixed period: slope = (n*Stx - St*Sx) / (n*Stt - St^2)
+ *  - sums St, Sx, Stx, Stt kept as 64-bit integers; add and evict
+ *    update them in O(1) whatever the window length
+ *  - t is the sample index; the time origin is moved to the oldest
+ *    sample every TREND_REBASE samples (O(1)) so the sums stay small
+ *  - result in 1/128 C per minute
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#ifndef _TEMP_TREND_H_INCLUDED
+#define _TEMP_TREND_H_INCLUDED
+
+#include <inttypes.h>
+
+#ifndef TREND_LEN
+#define TREND_LEN 120           // # samples in the window
+#endif
+#define TREND_REBASE 65536      // time origin moved after this many samples
+
+/**
+ * sliding-window slope estimator
+ *
+ */
+class TempTrend {
+public:
+   /**
+    * constructor.
+    * @param sample_ms sample period
+    */
+   TempTrend(uint32_t sample_ms);
+   ~TempTrend();                 // not used
+
+   /**
+    * discard all samples
+    */
+   void clear();
+
+   /**
+    * add a sample; the oldest one is evicted when the window is full
+    * @param q7 temperature in 1/128 C
+    */
+   void add(int32_t q7);
+
+   /**
+    * remove the oldest sample (no effect if empty)
+    */
+   void evict();
+
+   /**
+    * # samples in the window
+    */
+   int count();
+
+   /**
+    * slope of the window
+    * @return 1/128 C per minute (rounded); 0 with fewer than 2 samples
+    */
+   int32_t slope();
+
+private:
+   int16_t buf[TREND_LEN];
+   int head;            // next slot to write
+   int num;             // # samples
+   uint32_t t_next;     // index of the next sample
+   uint32_t per_min;    // # samples per minute
+   int64_t s_t;         // sum of t
+   int64_t s_x;         // sum of samples
+   int64_t s_tx;        // sum of t * sample
+   int64_t s_tt;        // sum of t^2
+
+   void rebase();
+};
+
+#endif  // _TEMP_TREND_H_INCLUDED
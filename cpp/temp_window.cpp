@@ -0,0 +1,76 @@
+/*****************************************************************//**
+ * @file temp_window.cpp
+ *
+ * @brief implementation of TempWindow class
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include "temp_window.h"
+#include "temperature.h"
+
+TempWindow::TempWindow() {
+   clear();
+}
+
+TempWindow::~TempWindow() {
+}
+
+void TempWindow::clear() {
+   head = 0;
+   num = 0;
+   sum = 0;
+   sum_sq = 0;
+}
+
+void TempWindow::add(int32_t q7) {
+   int16_t old, x;
+
+   if (num == TEMP_WINDOW_LEN) {
+      // retire the oldest sample
+      old = buf[head];
+      sum -= old;
+      sum_sq -= (int32_t) old * old;
+   } else {
+      num++;
+   }
+   // clamp to the stored width; the sums take the stored value, so
+   // retiring it later cancels its contribution exactly
+   if (q7 > INT16_MAX)
+      x = INT16_MAX;
+   else if (q7 < INT16_MIN)
+      x = INT16_MIN;
+   else
+      x = (int16_t) q7;
+   buf[head] = x;
+   sum += x;
+   sum_sq += (int32_t) x * x;
+   head = (head + 1) % TEMP_WINDOW_LEN;
+}
+
+int TempWindow::count() {
+   return (num);
+}
+
+int TempWindow::full() {
+   return (num == TEMP_WINDOW_LEN);
+}
+
+int32_t TempWindow::mean() {
+   if (num == 0)
+      return (0);
+   return (Temperature::rdiv(sum, num));
+}
+
+void TempWindow::stats(temp_window_t *s) {
+   int64_t d;
+
+   s->count = num;
+   s->mean = mean();
+   s->var = 0;
+   if (num == 0)
+      return;
+   // var = (n*sum_sq - sum^2) / n^2
+   d = (int64_t) num * sum_sq - (int64_t) sum * sum;
+   s->var = (uint32_t) (d / ((int64_t) num * num));
+}
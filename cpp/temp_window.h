@@ -0,0 +1,84 @@
+/*****************************************************************//**
+ * @file temp_window.h
+ *
+ * @brief sliding window of temperature samples
+ *
+ * Detailed description:
+ *  - last TEMP_WINDOW_LEN samples in 1/128 C (ADT7420 16-bit LSB)
+ *  - running sum and sum of squares updated in O(1) per sample;
+ *    integers only, so no drift however long the window runs
+ *  - mean and variance of the window taken in O(1) at any time
+ *  - static storage (no heap)
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#ifndef _TEMP_WINDOW_H_INCLUDED
+#define _TEMP_WINDOW_H_INCLUDED
+
+#include <inttypes.h>
+
+#ifndef TEMP_WINDOW_LEN
+#define TEMP_WINDOW_LEN 32      // # samples in the window (<= 256)
+#endif
+
+/**
+ * window statistics
+ */
+typedef struct {
+   int count;           // # samples (TEMP_WINDOW_LEN when full)
+   int32_t mean;        // mean in 1/128 C (rounded)
+   uint32_t var;        // variance in (1/128 C)^2 (1/16384 C^2)
+} temp_window_t;
+
+/**
+ * sliding-window accumulator
+ *  - oldest sample replaced once the window is full
+ *
+ */
+class TempWindow {
+public:
+   TempWindow();
+   ~TempWindow();                // not used
+
+   /**
+    * discard all samples
+    */
+   void clear();
+
+   /**
+    * add a sample
+    * @param q7 temperature in 1/128 C (clamped to int16_t)
+    */
+   void add(int32_t q7);
+
+   /**
+    * # samples in the window
+    */
+   int count();
+
+   /**
+    * 1 once TEMP_WINDOW_LEN samples have been added
+    */
+   int full();
+
+   /**
+    * mean in 1/128 C (0 if empty)
+    */
+   int32_t mean();
+
+   /**
+    * statistics of the current window
+    * @param s output
+    */
+   void stats(temp_window_t *s);
+
+private:
+   int16_t buf[TEMP_WINDOW_LEN];
+   int head;            // next slot to write
+   int num;             // # valid samples
+   int32_t sum;         // sum of samples
+   int64_t sum_sq;      // sum of squared samples
+};
+
+#endif  // _TEMP_WINDOW_H_INCLUDED
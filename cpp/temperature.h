@@ -0,0 +1,162 @@
+/*****************************************************************//**
+ * @file temperature.h
+ *
+ * @brief fixed-point temperature value type
+ *
+ * Detailed description:
+ *  - signed Q7 in degree Celsius (1/128 C), the LSB of the ADT7420
+ *    16-bit mode; a 13-bit code is the same value with 3 zero bits
+ *  - integer arithmetic only: no soft-float calls on the FPU-less
+ *    MicroBlaze MCS
+ *  - constexpr conversions to/from Celsius and Fahrenheit and to
+ *    scaled integers (e.g., m-degree) for display digits
+ *  - divisions round half away from zero
+ *  - 32-bit intermediates (no 64-bit division library calls);
+ *    exact for |t| < 1000 C with scale up to 1000
+ *  - header only
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#ifndef _TEMPERATURE_H_INCLUDED
+#define _TEMPERATURE_H_INCLUDED
+
+#include <inttypes.h>
+
+class Temperature {
+public:
+   enum {
+      FRAC_BITS = 7,           /**< fraction bits */
+      ONE = 1 << FRAC_BITS     /**< 1 C */
+   };
+
+   constexpr Temperature() : q(0) {}
+
+   /**
+    * value in 1/128 C
+    */
+   static constexpr Temperature from_q7(int32_t q7) {
+      return (Temperature(q7));
+   }
+
+   /**
+    * value of an ADT7420 temperature register
+    * @param raw register (msb:lsb)
+    * @param res16 1: 16-bit resolution; 0: 13-bit (bits 2-0 are flags)
+    */
+   static constexpr Temperature from_raw(uint16_t raw, int res16) {
+      return (Temperature(res16 ? (int32_t) (int16_t) raw
+            : (int32_t) (int16_t) (raw & 0xfff8)));
+   }
+
+   /**
+    * value of a temperature in m-degree Celsius
+    */
+   static constexpr Temperature from_mc(int32_t mc) {
+      return (Temperature(rdiv(mc * ONE, 1000)));
+   }
+
+   /**
+    * value of a temperature in m-degree Fahrenheit
+    */
+   static constexpr Temperature from_mf(int32_t mf) {
+      return (Temperature(rdiv((mf - 32000) * 5 * ONE, 9000)));
+   }
+
+   /**
+    * temperature in 1/128 C
+    */
+   constexpr int32_t q7() const {
+      return (q);
+   }
+
+   /**
+    * temperature in 1/128 F
+    */
+   constexpr int32_t f_q7() const {
+      return (rdiv(q * 9, 5) + 32 * ONE);
+   }
+
+   /**
+    * temperature in units of 1/scale C, e.g., scale 1000 for m-degree
+    */
+   constexpr int32_t c_scaled(int32_t scale) const {
+      return (rdiv(q * scale, ONE));
+   }
+
+   /**
+    * temperature in units of 1/scale F
+    */
+   constexpr int32_t f_scaled(int32_t scale) const {
+      return ((rdiv(q * 9 * scale, 5 * ONE) + 32 * scale));
+   }
+
+   /**
+    * whole degrees Celsius (rounded)
+    */
+   constexpr int32_t c_round() const {
+      return (c_scaled(1));
+   }
+
+   constexpr Temperature abs() const {
+      return (Temperature(q < 0 ? -q : q));
+   }
+
+   /* arithmetic */
+   constexpr Temperature operator+(Temperature t) const {
+      return (Temperature(q + t.q));
+   }
+   constexpr Temperature operator-(Temperature t) const {
+      return (Temperature(q - t.q));
+   }
+   constexpr Temperature operator-() const {
+      return (Temperature(-q));
+   }
+   constexpr Temperature operator*(int32_t k) const {
+      return (Temperature(q * k));
+   }
+   constexpr Temperature operator/(int32_t k) const {
+      return (Temperature(rdiv(q, k)));
+   }
+   Temperature &operator+=(Temperature t) {
+      q += t.q;
+      return (*this);
+   }
+   Temperature &operator-=(Temperature t) {
+      q -= t.q;
+      return (*this);
+   }
+
+   /* comparison */
+   constexpr bool operator==(Temperature t) const {
+      return (q == t.q);
+   }
+   constexpr bool operator!=(Temperature t) const {
+      return (q != t.q);
+   }
+   constexpr bool operator<(Temperature t) const {
+      return (q < t.q);
+   }
+   constexpr bool operator<=(Temperature t) const {
+      return (q <= t.q);
+   }
+   constexpr bool operator>(Temperature t) const {
+      return (q > t.q);
+   }
+   constexpr bool operator>=(Temperature t) const {
+      return (q >= t.q);
+   }
+
+   /**
+    * n/d rounded half away from zero (d > 0)
+    */
+   static constexpr int32_t rdiv(int32_t n, int32_t d) {
+      return (n >= 0 ? (n + d / 2) / d : -((-n + d / 2) / d));
+   }
+
+private:
+   int32_t q;     // 1/128 C
+   explicit constexpr Temperature(int32_t q7) : q(q7) {}
+};
+
+#endif  // _TEMPERATURE_H_INCLUDED
@@ -41,24 +41,41 @@ void TimerCore::clear() {
 }
 
 uint64_t TimerCore::read_tick() {
-   uint64_t upper, lower;
+   uint32_t upper, lower;
 
-   lower = (uint64_t) io_read(base_addr, COUNTER_LOWER_REG);
-   upper = (uint64_t) io_read(base_addr, COUNTER_UPPER_REG);
-   return ((upper << 32) | lower);
+   // the lower word may roll over between the two reads;
+   // if it has just wrapped, it may have done so after upper
+   // was read, so upper is read again (a stale upper would make
+   // the count 2^32 ticks too small)
+   upper = io_read(base_addr, COUNTER_UPPER_REG);
+   lower = io_read(base_addr, COUNTER_LOWER_REG);
+   if (lower < TICK_WRAP_WINDOW)
+      upper = io_read(base_addr, COUNTER_UPPER_REG);
+   return (((uint64_t) upper << 32) | lower);
+}
+
+uint32_t TimerCore::read_tick32() {
+   return (io_read(base_addr, COUNTER_LOWER_REG));
 }
 
 uint64_t TimerCore::read_time() {
    // elapsed time in microsecond (SYS_CLK_FREQ in MHz)
-   return (read_tick() / SYS_CLK_FREQ);
+   return (ticks_to_us(read_tick()));
 }
 
 void TimerCore::sleep(uint64_t us) {
-   uint64_t start_time, now;
+   uint64_t ticks, end;
+   uint32_t start;
 
-   start_time = read_time();
-   // busy waiting
-   do {
-      now = read_time();
-   } while ((now - start_time) < us);
+   ticks = us_to_ticks(us);
+   // busy waiting on the tick count
+   if (ticks < TICK32_SPAN) {
+      start = read_tick32();
+      while ((uint32_t) (read_tick32() - start) < (uint32_t) ticks) {
+      }
+   } else {
+      end = read_tick() + ticks;
+      while (read_tick() < end) {
+      }
+   }
 }
@@ -13,6 +13,100 @@
 #include "chu_io_rw.h"
 #include "chu_io_map.h"      /* to obtain system clock rate  */
 
+/**
+ * division by a constant without a divide instruction
+ *  - MicroBlaze MCS has no hardware divider; "/" becomes a libgcc call
+ *  - x/D computed as ((x >> Z) * M) >> (32 + S) with a 32-bit M
+ *  - Z (trailing 0 bits of D), M and S derived at compile time;
+ *    result exact for every 32-bit x
+ *  - 64-bit x split into 32-bit parts using 2^32 = Q*D + R
+ *  - compilation fails (static_assert) if D has no 32-bit multiplier
+ */
+template<uint32_t D>
+struct ConstDiv {
+   static constexpr int tz(uint32_t d) {
+      return ((d & 1) ? 0 : 1 + tz(d >> 1));
+   }
+   static constexpr int Z = tz(D);
+   static constexpr uint32_t DO = D >> Z;    // odd part of D
+   static constexpr uint64_t m_of(int s) {
+      return (((1ULL << (32 + s)) + DO - 1) / DO);
+   }
+   // m fits 32 bits and rounding error small enough for all x
+   static constexpr bool ok(int s) {
+      return (m_of(s) <= 0xffffffffULL
+            && m_of(s) * DO - (1ULL << (32 + s)) <= (1ULL << (s + Z)));
+   }
+   static constexpr int find(int s) {
+      return ((DO == 1) ? 0 : (s > 31) ? -1 : ok(s) ? s : find(s + 1));
+   }
+   static constexpr int S = find(0);
+   static_assert(S >= 0, "divisor has no 32-bit reciprocal");
+   static constexpr uint32_t M = (uint32_t) m_of(S);
+   static constexpr uint32_t Q = (uint32_t) ((1ULL << 32) / D);
+   static constexpr uint32_t R = (uint32_t) ((1ULL << 32) % D);
+
+   static uint32_t div32(uint32_t x) {
+      if (DO == 1)
+         return (x >> Z);
+      return ((uint32_t) (((uint64_t) (x >> Z) * M) >> (32 + S)));
+   }
+
+   static uint64_t div64(uint64_t x) {
+      uint32_t hi = (uint32_t) (x >> 32);
+      uint64_t q = 0, r = x;
+
+      // x = hi*(Q*D + R) + lo; fold hi*R back until r fits 32 bits
+      while (hi) {
+         q = q + (uint64_t) hi * Q;
+         r = (uint64_t) hi * R + (uint32_t) r;
+         hi = (uint32_t) (r >> 32);
+      }
+      return (q + div32((uint32_t) r));
+   }
+};
+
+/**********************************************************************
+ * time base conversion
+ *  - tick: one system clock (1/SYS_CLK_FREQ us)
+ *  - tick -> time conversion by ConstDiv (no division at run time)
+ *  - TICK32_SPAN: longest interval (2^31 ticks; 21 s at 100 MHz)
+ *    that can be measured with the lower 32 bits of the counter
+ *    using wrap-safe arithmetic
+ *********************************************************************/
+#define TICK32_SPAN 0x80000000UL
+
+/**
+ * read_tick() re-reads the upper word when the lower word is below
+ * this value (2^24 ticks, 168 ms at 100 MHz), i.e., it may have
+ * wrapped between the two register reads; the two reads must not be
+ * separated (e.g., by an interrupt) longer than this window
+ */
+#define TICK_WRAP_WINDOW 0x01000000UL
+
+typedef ConstDiv<SYS_CLK_FREQ> TickPerUs;
+typedef ConstDiv<SYS_CLK_FREQ * 1000> TickPerMs;
+
+inline uint64_t us_to_ticks(uint64_t us) {
+   return (us * SYS_CLK_FREQ);
+}
+
+inline uint64_t ms_to_ticks(uint64_t ms) {
+   return (ms * (SYS_CLK_FREQ * 1000));
+}
+
+inline uint64_t ticks_to_us(uint64_t ticks) {
+   return (TickPerUs::div64(ticks));
+}
+
+inline uint64_t ticks_to_ms(uint64_t ticks) {
+   return (TickPerMs::div64(ticks));
+}
+
+inline uint32_t ticks32_to_us(uint32_t ticks) {
+   return (TickPerUs::div32(ticks));
+}
+
 /**
  * timer core driver:
  *  - control and retrieve clock count from MMIO timer core.
@@ -69,9 +163,20 @@ public:
    /**
     * read current timing counter value (# clocks elapsed from last clear)
     *
+    * @note upper word re-read when the lower word may have wrapped
+    *       between the two register reads
+    *
     */
    uint64_t read_tick();
 
+   /**
+    * read lower 32 bits of timing counter (single register read)
+    *
+    * @note for wrap-safe interval measurement (up to TICK32_SPAN)
+    *
+    */
+   uint32_t read_tick32();
+
    /**
     * read current time (microseconds elapsed from last clear)
     *
@@ -85,6 +190,8 @@ public:
     *
     * @param us idle time in micro second
     * @note will block the program execution
+    * @note spins on the tick count (32-bit read when shorter
+    *       than TICK32_SPAN); no conversion inside the loop
     *
     */
    void sleep(uint64_t us);
@@ -94,4 +201,89 @@ private:
    uint32_t ctrl;    // current state of control register
 };
 
+/**
+ * timer core driver bound to slot SLOT at compile time
+ *  - e.g., slot::TimerCore<S0_SYS_TIMER>
+ *  - register addresses are compile-time constants
+ *  - constexpr constructor does not touch the hardware;
+ *    init() clears and enables the counter
+ *  - same methods as ::TimerCore
+ */
+namespace slot {
+
+template<int SLOT>
+class TimerCore {
+public:
+   enum {
+      COUNTER_LOWER_REG = ::TimerCore::COUNTER_LOWER_REG,
+      COUNTER_UPPER_REG = ::TimerCore::COUNTER_UPPER_REG,
+      CTRL_REG = ::TimerCore::CTRL_REG
+   };
+   enum {
+      GO_FIELD = ::TimerCore::GO_FIELD,
+      CLR_FIELD = ::TimerCore::CLR_FIELD
+   };
+   static constexpr uint32_t base_addr = get_slot_addr(BRIDGE_BASE, SLOT);
+
+   constexpr TimerCore() : ctrl(0x01) {
+   }
+
+   void init() {
+      ctrl = 0x01;
+      clear();
+      io_write(base_addr, CTRL_REG, ctrl);  // enable the timer
+   }
+
+   void pause() {
+      ctrl = ctrl & ~GO_FIELD;
+      io_write(base_addr, CTRL_REG, ctrl);
+   }
+
+   void go() {
+      ctrl = ctrl | GO_FIELD;
+      io_write(base_addr, CTRL_REG, ctrl);
+   }
+
+   void clear() {
+      io_write(base_addr, CTRL_REG, ctrl | CLR_FIELD);
+   }
+
+   uint64_t read_tick() {
+      uint32_t upper, lower;
+
+      upper = io_read(base_addr, COUNTER_UPPER_REG);
+      lower = io_read(base_addr, COUNTER_LOWER_REG);
+      if (lower < TICK_WRAP_WINDOW)   // lower may have wrapped after upper read
+         upper = io_read(base_addr, COUNTER_UPPER_REG);
+      return (((uint64_t) upper << 32) | lower);
+   }
+
+   uint32_t read_tick32() {
+      return (io_read(base_addr, COUNTER_LOWER_REG));
+   }
+
+   uint64_t read_time() {
+      return (ticks_to_us(read_tick()));
+   }
+
+   void sleep(uint64_t us) {
+      uint64_t ticks = us_to_ticks(us);
+
+      if (ticks < TICK32_SPAN) {
+         uint32_t start = read_tick32();
+         while ((uint32_t) (read_tick32() - start) < (uint32_t) ticks) {
+         }
+      } else {
+         uint64_t end = read_tick() + ticks;
+         while (read_tick() < end) {
+         }
+      }
+   }
+
+private:
+   uint32_t ctrl;    // current state of control register
+};
+
+} // namespace slot
+
 #endif  // _TIMER_H_INCLUDED
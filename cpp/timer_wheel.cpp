@@ -0,0 +1,180 @@
+/*****************************************************************//**
+ * @file timer_wheel.cpp
+ *
+ * @brief implementation of TimerWheel class
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include "timer_wheel.h"
+
+TimerWheel::TimerWheel(TimerCore *timer_p) {
+   timer = timer_p;
+   last = 0;
+   cur = 0;
+   init_done = 0;
+   free_head = NIL;
+}
+
+TimerWheel::~TimerWheel() {
+}
+
+// build empty slots and free list; start the wheel from now
+void TimerWheel::init() {
+   int i;
+
+   for (i = 0; i < TIMER_WHEEL_SLOTS; i++)
+      head[i] = NIL;
+   for (i = 0; i < TIMER_WHEEL_POOL; i++) {
+      pool[i].cb = 0;
+      pool[i].gen = 0;
+      pool[i].next = (i == TIMER_WHEEL_POOL - 1) ? (uint8_t) NIL : (uint8_t) (i + 1);
+   }
+   free_head = 0;
+   last = timer->read_tick32();
+   init_done = 1;
+}
+
+// # wheel ticks from now to ms later (rounded up; at least 1)
+uint32_t TimerWheel::ms_to_wticks(uint32_t ms) {
+   uint64_t rel;
+   uint32_t n;
+
+   // part of the current wheel tick already elapsed counts as well
+   rel = (uint64_t) (timer->read_tick32() - last) + ms_to_ticks(ms);
+   n = (uint32_t) ((rel + GRANULE - 1) >> TIMER_WHEEL_SHIFT);
+   return ((n == 0) ? 1 : n);
+}
+
+// insert entry i into the slot of its expiry tick
+void TimerWheel::link(int i) {
+   int s = pool[i].expiry & (TIMER_WHEEL_SLOTS - 1);
+
+   pool[i].prev = NIL;
+   pool[i].next = head[s];
+   if (head[s] != NIL)
+      pool[head[s]].prev = (uint8_t) i;
+   head[s] = (uint8_t) i;
+}
+
+// remove entry i from its slot
+void TimerWheel::unlink(int i) {
+   int s = pool[i].expiry & (TIMER_WHEEL_SLOTS - 1);
+
+   if (pool[i].prev == NIL)
+      head[s] = pool[i].next;
+   else
+      pool[pool[i].prev].next = pool[i].next;
+   if (pool[i].next != NIL)
+      pool[pool[i].next].prev = pool[i].prev;
+}
+
+// return entry i to the free list; invalidate outstanding handles
+void TimerWheel::release(int i) {
+   pool[i].cb = 0;
+   pool[i].gen++;
+   pool[i].next = free_head;
+   free_head = (uint8_t) i;
+}
+
+int TimerWheel::start(uint32_t delay_ms, uint32_t period_ms,
+      TimerCallback cb, void *arg) {
+   int i;
+
+   if (!init_done)
+      init();
+   if (free_head == NIL || cb == 0)
+      return (-1);
+   i = free_head;
+   free_head = pool[i].next;
+   pool[i].cb = cb;
+   pool[i].arg = arg;
+   pool[i].expiry = cur + ms_to_wticks(delay_ms);
+   pool[i].period = (uint32_t) ms_to_ticks(period_ms);
+   pool[i].frac = 0;
+   link(i);
+   return ((pool[i].gen << 8) | i);
+}
+
+int TimerWheel::start_once(uint32_t ms, TimerCallback cb, void *arg) {
+   return (start(ms, 0, cb, arg));
+}
+
+int TimerWheel::start_periodic(uint32_t ms, TimerCallback cb, void *arg) {
+   return (start(ms, ms, cb, arg));
+}
+
+int TimerWheel::active(int handle) {
+   int i = handle & 0xff;
+
+   if (handle < 0 || i >= TIMER_WHEEL_POOL || !init_done)
+      return (0);
+   return (pool[i].cb != 0 && pool[i].gen == ((handle >> 8) & 0xff));
+}
+
+void TimerWheel::cancel(int handle) {
+   int i = handle & 0xff;
+
+   if (!active(handle))
+      return;
+   unlink(i);
+   release(i);
+}
+
+int TimerWheel::used() {
+   int i, n = 0;
+
+   if (!init_done)
+      return (0);
+   for (i = 0; i < TIMER_WHEEL_POOL; i++)
+      if (pool[i].cb)
+         n++;
+   return (n);
+}
+
+// move to next wheel tick; fire timers expiring at that tick
+void TimerWheel::step() {
+   TimerCallback cb;
+   void *arg;
+   uint32_t frac;
+   int s, i;
+
+   cur++;
+   s = cur & (TIMER_WHEEL_SLOTS - 1);
+   i = head[s];
+   while (i != NIL) {
+      if (pool[i].expiry != cur) {   // later revolution
+         i = pool[i].next;
+         continue;
+      }
+      cb = pool[i].cb;
+      arg = pool[i].arg;
+      unlink(i);
+      if (pool[i].period) {
+         // sub-tick part of the period carried over: no drift
+         frac = pool[i].frac + pool[i].period;
+         pool[i].expiry = cur + ((frac < GRANULE) ? 1 : (frac >> TIMER_WHEEL_SHIFT));
+         pool[i].frac = (frac < GRANULE) ? 0 : (frac & (GRANULE - 1));
+         link(i);
+      } else {
+         release(i);
+      }
+      cb(arg);
+      // callback may have changed this slot; rescan from its head
+      // (re-armed periodic timers are at least one tick later)
+      i = head[s];
+   }
+}
+
+void TimerWheel::advance() {
+   uint32_t elapsed;
+
+   if (!init_done)
+      init();
+   elapsed = timer->read_tick32() - last;
+   while (elapsed >= GRANULE) {
+      last = last + GRANULE;
+      elapsed = elapsed - GRANULE;
+      step();
+   }
+}
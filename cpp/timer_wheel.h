@@ -0,0 +1,145 @@
+/*****************************************************************//**
+ * @file timer_wheel.h
+ *
+ * @brief software timers multiplexed on a timer core
+ *
+ * Detailed description:
+ *  - hashed timer wheel driven by the tick counter of a TimerCore
+ *  - one-shot and periodic callbacks
+ *  - fixed-capacity static pool (no heap)
+ *  - O(1) insert/cancel; expiry O(1) per timer in the visited slot
+ *  - callbacks run from advance(), which must be called regularly
+ *    from the main loop (at least once per TICK32_SPAN ticks)
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#ifndef _TIMER_WHEEL_H_INCLUDED
+#define _TIMER_WHEEL_H_INCLUDED
+
+#include "timer_core.h"
+
+#ifndef TIMER_WHEEL_POOL
+#define TIMER_WHEEL_POOL 16     // max # active timers (< 255)
+#endif
+#ifndef TIMER_WHEEL_SLOTS
+#define TIMER_WHEEL_SLOTS 256   // # wheel slots (power of 2)
+#endif
+#ifndef TIMER_WHEEL_SHIFT
+#define TIMER_WHEEL_SHIFT 17    // wheel tick = 2^17 clocks (1.31 ms @100 MHz)
+#endif
+
+/**
+ * timer callback
+ * @param arg argument given when the timer was started
+ */
+typedef void (*TimerCallback)(void *arg);
+
+/**
+ * hashed timer wheel
+ *  - a timer is placed in slot (expiry tick % TIMER_WHEEL_SLOTS);
+ *    timers further than one revolution share a slot and are
+ *    skipped until their expiry tick is reached
+ *  - timers are handled by handles; a stale handle (timer already
+ *    expired or canceled) is detected and ignored
+ *
+ */
+class TimerWheel {
+public:
+   enum {
+      NIL = 0xff,         /**< end of list */
+      GRANULE = 1UL << TIMER_WHEEL_SHIFT  /**< clocks per wheel tick */
+   };
+
+   /**
+    * constructor.
+    * @param timer_p timer core providing the tick count
+    * @note timer core not accessed until the first start/advance
+    */
+   TimerWheel(TimerCore *timer_p);
+   ~TimerWheel();                // not used
+
+   /**
+    * start a timer
+    * @param delay_ms time to first expiry in ms
+    * @param period_ms period in ms after first expiry (0: one-shot);
+    *        must be shorter than TICK32_SPAN clocks; a period
+    *        shorter than one wheel tick expires every wheel tick
+    * @param cb callback function
+    * @param arg argument passed to callback
+    * @return timer handle; -1 if the pool is exhausted
+    *
+    */
+   int start(uint32_t delay_ms, uint32_t period_ms, TimerCallback cb,
+         void *arg);
+
+   /**
+    * start a one-shot timer
+    * @param ms delay in ms
+    * @param cb callback function
+    * @param arg argument passed to callback
+    * @return timer handle; -1 if the pool is exhausted
+    */
+   int start_once(uint32_t ms, TimerCallback cb, void *arg);
+
+   /**
+    * start a periodic timer
+    * @param ms period (and first delay) in ms
+    * @param cb callback function
+    * @param arg argument passed to callback
+    * @return timer handle; -1 if the pool is exhausted
+    */
+   int start_periodic(uint32_t ms, TimerCallback cb, void *arg);
+
+   /**
+    * cancel a timer
+    * @param handle timer handle (stale/-1 handle ignored)
+    */
+   void cancel(int handle);
+
+   /**
+    * check whether a timer is pending
+    * @param handle timer handle
+    * @return 1 if pending
+    */
+   int active(int handle);
+
+   /**
+    * process elapsed wheel ticks and run expired callbacks
+    * @note a callback may start or cancel timers
+    */
+   void advance();
+
+   /**
+    * # timers currently pending
+    */
+   int used();
+
+private:
+   struct Entry {
+      TimerCallback cb;   // 0: entry free
+      void *arg;
+      uint32_t expiry;    // wheel tick # of expiry
+      uint32_t period;    // in clocks; 0: one-shot
+      uint32_t frac;      // clocks carried over to the next period
+      uint8_t prev;
+      uint8_t next;
+      uint8_t gen;        // incremented on each release
+   };
+   TimerCore *timer;
+   uint32_t last;         // tick32 at start of current wheel tick
+   uint32_t cur;          // current wheel tick #
+   uint8_t free_head;
+   uint8_t init_done;
+   uint8_t head[TIMER_WHEEL_SLOTS];
+   Entry pool[TIMER_WHEEL_POOL];
+
+   void init();
+   uint32_t ms_to_wticks(uint32_t ms);
+   void link(int i);
+   void unlink(int i);
+   void release(int i);
+   void step();
+};
+
+#endif  // _TIMER_WHEEL_H_INCLUDED
@@ -8,9 +8,16 @@
  ********************************************************************/
 
 #include "uart_core.h"
+#include "chu_fmt.h"
+#include "chu_cobs.h"
 
 UartCore::UartCore(uint32_t core_base_addr) {
    base_addr = core_base_addr;
+   tx_policy = TX_SYNC;
+   tx_head = 0;
+   tx_num = 0;
+   tx_max = 0;
+   tx_drop = 0;
    set_baud_rate(9600);      //default baud rate
 }
 
@@ -44,11 +51,75 @@ int UartCore::tx_fifo_full() {
 }
 
 void UartCore::tx_byte(uint8_t byte) {
+   if (tx_policy != TX_SYNC) {
+      tx_queue(byte);
+      return;
+   }
    while (tx_fifo_full()) {
    };  // busy waiting
    io_write(base_addr, WR_DATA_REG, (uint32_t )byte);
 }
 
+/**********************************************************************
+ * buffered transmit
+ *********************************************************************/
+void UartCore::tx_queue(uint8_t byte) {
+   if (tx_num == UART_TX_BUF_SIZE) {
+      if (tx_policy == TX_DROP_NEWEST) {
+         tx_drop++;
+         return;
+      } else if (tx_policy == TX_DROP_OLDEST) {
+         tx_head = (tx_head + 1) & (UART_TX_BUF_SIZE - 1);
+         tx_num--;
+         tx_drop++;
+      } else {    // TX_BLOCK
+         while (tx_drain() == UART_TX_BUF_SIZE) {
+         };  // busy waiting
+      }
+   }
+   tx_buf[(tx_head + tx_num) & (UART_TX_BUF_SIZE - 1)] = byte;
+   tx_num++;
+   if (tx_num > tx_max)
+      tx_max = tx_num;
+}
+
+int UartCore::tx_drain() {
+   while (tx_num > 0 && !tx_fifo_full()) {
+      io_write(base_addr, WR_DATA_REG, (uint32_t) tx_buf[tx_head]);
+      tx_head = (tx_head + 1) & (UART_TX_BUF_SIZE - 1);
+      tx_num--;
+   }
+   return (tx_num);
+}
+
+void UartCore::tx_flush() {
+   while (tx_drain() > 0) {
+   };  // busy waiting
+}
+
+void UartCore::set_tx_policy(int policy) {
+   if (policy == TX_SYNC)
+      tx_flush();
+   tx_policy = policy;
+}
+
+int UartCore::tx_pending() {
+   return (tx_num);
+}
+
+uint32_t UartCore::tx_dropped() {
+   return (tx_drop);
+}
+
+int UartCore::tx_peak() {
+   return (tx_max);
+}
+
+void UartCore::tx_stats_clear() {
+   tx_drop = 0;
+   tx_max = tx_num;
+}
+
 int UartCore::rx_byte() {
    uint32_t data;
 
@@ -70,8 +141,74 @@ void UartCore::disp(char ch) {
 }
 
 void UartCore::disp(int n, int base, int len) {
-   char buf[33];         // 32 bit #
-   char *str, ch, sign;
+   char buf[INT_STR_LEN];
+
+   disp_str(int2str(n, base, len, buf));
+}
+
+void UartCore::disp(int n) {
+   disp(n, 10, 0);
+}
+
+void UartCore::disp(int n, int base) {
+   disp(n, base, 0);
+}
+
+void UartCore::disp(double f, int digit) {
+   char buf[DBL_STR_LEN];
+
+   disp_str(dbl2str(f, digit, buf));
+}
+
+void UartCore::disp(double f) {
+   disp(f, 3);
+}
+
+int UartCore::printf(const char *fmt, ...) {
+   char buf[UART_FMT_LEN];
+   va_list ap;
+   int n;
+
+   va_start(ap, fmt);
+   n = fmt_vformat(buf, UART_FMT_LEN, fmt, ap);
+   va_end(ap);
+   tx_bytes((const uint8_t *) buf, n);
+   return (n);
+}
+
+int UartCore::tx_frame(const uint8_t *payload, int n) {
+   uint8_t buf[COBS_ENC_LEN(COBS_MAX_DATA) + 1];
+   int len;
+
+   len = cobs_frame(payload, n, buf);
+   if (len > 0)
+      tx_bytes(buf, len);
+   return (len);
+}
+
+void UartCore::tx_bytes(const uint8_t *data, int n) {
+   int i, k;
+
+   if (tx_policy == TX_SYNC) {
+      for (i = 0; i < n; i++)
+         tx_byte(data[i]);
+      return;
+   }
+   // copy the part that fits in one pass; overflow handled per byte
+   k = UART_TX_BUF_SIZE - tx_num;
+   if (k > n)
+      k = n;
+   for (i = 0; i < k; i++)
+      tx_buf[(tx_head + tx_num + i) & (UART_TX_BUF_SIZE - 1)] = data[i];
+   tx_num = tx_num + k;
+   if (tx_num > tx_max)
+      tx_max = tx_num;
+   for (i = k; i < n; i++)
+      tx_queue(data[i]);
+}
+
+char *UartCore::int2str(int n, int base, int len, char *buf) {
+   char *str, ch;
    int rem, i;
    unsigned int un;
 
@@ -80,16 +217,14 @@ void UartCore::disp(int n, int base, int len) {
       base = 10;
    if (len > 32)
       len = 32;
-   /* handle neg decimal # */
-   if (base == 10 && n < 0) {
-      un = (unsigned) -n;
-      sign = '-';
-   } else {
-      un = (unsigned) n; // interpreted as unsigned for hex/bin conversion
-      sign = ' ';
+   /* decimal: digit-pair conversion (same format) */
+   if (base == 10) {
+      fmt_dec(buf, n, len, 0);
+      return (buf);
    }
+   un = (unsigned) n; // interpreted as unsigned for hex/oct/bin conversion
    /* convert # to string */
-   str = &buf[33];
+   str = &buf[INT_STR_LEN - 1];
    *str = '\0';
    i = 0;
    do {
@@ -103,61 +238,53 @@ void UartCore::disp(int n, int base, int len) {
       *str = ch;
       i++;
    } while (un);
-   /* attach - sign for neg decimal # */
-   if (sign == '-') {
-      str--;
-      *str = sign;
-      i++;
-   }
    /* pad with blank */
    while (i < len) {
       str--;
       *str = ' ';
       i++;
    };
-   disp_str(str);
-}
-
-void UartCore::disp(int n) {
-   disp(n, 10, 0);
-}
-
-void UartCore::disp(int n, int base) {
-   disp(n, base, 0);
+   return (str);
 }
 
-void UartCore::disp(double f, int digit) {
+char *UartCore::dbl2str(double f, int digit, char *buf) {
+   char ibuf[INT_STR_LEN];
    double fa, frac; // absolute value of f
+   char *str, *istr;
    int n, i, i_part;
 
+   if (digit > DBL_DIGIT_MAX)
+      digit = DBL_DIGIT_MAX;
+   str = buf;
    fa = f;
    if (f < 0.0) {
       fa = -f;
-      disp_str("-");
+      *str++ = '-';
    }
-   // display integer portion
+   // integer portion
    i_part = (int) fa; // integer part of f
-   disp(i_part);
-   disp_str(".");
-   // display fraction part
+   istr = int2str(i_part, 10, 0, ibuf);
+   while (*istr)
+      *str++ = *istr++;
+   *str++ = '.';
+   // fraction part
    frac = fa - (double) i_part;
    for (n = 0; n < digit; n++) {
       frac = frac * 10.0;
       i = (int) frac;
-      disp(i);
+      *str++ = (char) i + '0';
       frac = frac - i;
    }
-}
-
-void UartCore::disp(double f) {
-   disp(f, 3);
+   *str = '\0';
+   return (buf);
 }
 
 void UartCore::disp_str(const char *str) {
-   while ((uint8_t) *str) {
-      tx_byte(*str);
-      str++;
-   }
+   int n = 0;
+
+   while ((uint8_t) str[n])
+      n++;
+   tx_bytes((const uint8_t *) str, n);
 }
 
 
@@ -13,10 +13,26 @@
 
 #include "chu_io_rw.h"
 #include "chu_io_map.h"  // to use SYS_CLK_FREQ
+#include "chu_fmt.h"     // to use FMT_NUM_LEN
+
+#ifndef UART_FMT_LEN
+#define UART_FMT_LEN 128        // max # chars of one printf() output
+#endif
+#ifndef UART_TX_BUF_SIZE
+#define UART_TX_BUF_SIZE 1024   // software tx ring size (power of 2)
+#endif
+
 /**
  * uart core driver
  * - transmit/receive data via MMIO uart core.
  * - display (print) number and string on serial console
+ * - optional buffered (asynchronous) transmit:
+ *    - enabled by set_tx_policy() with a policy other than TX_SYNC
+ *    - tx_byte()/disp() only copy data into a software ring
+ *      (no bus access)
+ *    - tx_drain() moves data from the ring into the tx fifo
+ *      without waiting; to be called regularly from the main loop
+ *    - policy determines what happens when the ring is full
  *
  */
 class UartCore {
@@ -40,6 +56,16 @@ class UartCore {
       RX_DATA_FIELD = 0x000000ff  /**< bits 7..0 rd_data_reg; read data */
    };
 public:
+   /**
+    * transmit policy
+    *
+    */
+   enum {
+      TX_SYNC = 0,     /**< no ring; busy wait on the tx fifo (default) */
+      TX_BLOCK,        /**< ring full: busy wait until a byte is sent */
+      TX_DROP_OLDEST,  /**< ring full: discard the oldest queued byte */
+      TX_DROP_NEWEST   /**< ring full: discard the new byte */
+   };
    /* methods */
    /**
     * constructor.
@@ -80,9 +106,53 @@ public:
     *
     * @note the function "busy waits" if tx fifo is full;
     *       to avoid "blocking" execution, use tx_fifo_full() to check status as needed
+    * @note in buffered mode the byte is queued in the ring instead
     */
    void tx_byte(uint8_t byte);
 
+   /**
+    * select transmit policy
+    *
+    * @param policy TX_SYNC, TX_BLOCK, TX_DROP_OLDEST or TX_DROP_NEWEST
+    * @note switching to TX_SYNC flushes the ring first
+    */
+   void set_tx_policy(int policy);
+
+   /**
+    * move queued bytes into the tx fifo until it is full
+    *
+    * @return # bytes still queued
+    * @note does not "busy wait"
+    */
+   int tx_drain();
+
+   /**
+    * send all queued bytes
+    *
+    * @note the function "busy waits" until the ring is empty
+    */
+   void tx_flush();
+
+   /**
+    * # bytes queued in the ring
+    */
+   int tx_pending();
+
+   /**
+    * # bytes discarded by TX_DROP_OLDEST/TX_DROP_NEWEST
+    */
+   uint32_t tx_dropped();
+
+   /**
+    * max # bytes queued in the ring since last tx_stats_clear()
+    */
+   int tx_peak();
+
+   /**
+    * clear the dropped-byte and peak-backlog counters
+    */
+   void tx_stats_clear();
+
    /**
     * receive a byte
     *
@@ -165,10 +235,182 @@ public:
     */
    void disp(double f);
 
+   /**
+    * formatted print on a serial terminal console
+    *
+    * @param fmt format string (see chu_fmt.h; %d %u %x %s %c %qN ...)
+    * @return # chars sent
+    * @note formatted into a local buffer (UART_FMT_LEN chars max),
+    *       then sent with a single tx_bytes() call
+    * @note e.g., uart.printf("%.3q4 C\n\r", code) prints a Q4
+    *       fixed-point temperature without floating-point math
+    *
+    */
+   int printf(const char *fmt, ...);
+
+   /**
+    * transmit a block of bytes
+    *
+    * @param data pointer to the bytes
+    * @param n # bytes
+    * @note in buffered mode, copied into the ring in one pass
+    *
+    */
+   void tx_bytes(const uint8_t *data, int n);
+
+   /**
+    * transmit a binary message as a COBS frame with CRC-16
+    *
+    * @param payload message bytes
+    * @param n # bytes (up to COBS_MAX_DATA - 2)
+    * @return # bytes sent; -1 if payload too long
+    * @note frame format in chu_cobs.h; frames delimited by 0x00
+    *
+    */
+   int tx_frame(const uint8_t *payload, int n);
+
+   /**
+    * buffer sizes for the number-to-string conversion
+    *
+    */
+   enum {
+      INT_STR_LEN = FMT_NUM_LEN, /**< as fmt_dec() requires */
+      DBL_STR_LEN = 48,  /**< sign + 10 integer digits + '.' + fraction */
+      DBL_DIGIT_MAX = 32 /**< max # digits in fraction portion */
+   };
+
+   /**
+    * convert an integer to a string (format used by disp(n, base, len))
+    *
+    * @param n integer to be converted
+    * @param base 2/8/10/16 for binary/octal/decimal/hex format
+    * @param len # of digits (length); padded with blanks
+    * @param buf buffer of at least INT_STR_LEN chars
+    * @return pointer to the null-terminated string within buf
+    *
+    */
+   static char *int2str(int n, int base, int len, char *buf);
+
+   /**
+    * convert a floating-point number to a string (format used by disp(f, digit))
+    *
+    * @param f floating-point number to be converted
+    * @param digit # of digits in fraction portion (up to DBL_DIGIT_MAX)
+    * @param buf buffer of at least DBL_STR_LEN chars
+    * @return pointer to the null-terminated string (buf)
+    *
+    */
+   static char *dbl2str(double f, int digit, char *buf);
+
 private:
    uint32_t base_addr;
    int baud_rate;
+   int tx_policy;
+   uint16_t tx_head;      // index of oldest queued byte
+   uint16_t tx_num;       // # queued bytes
+   uint16_t tx_max;       // peak backlog
+   uint32_t tx_drop;      // # dropped bytes
+   uint8_t tx_buf[UART_TX_BUF_SIZE];
    void disp_str(const char *str);
+   void tx_queue(uint8_t byte);
 };
 
+/**
+ * uart core driver bound to slot SLOT at compile time
+ *  - e.g., slot::UartCore<S1_UART1>
+ *  - register addresses are compile-time constants
+ *  - constexpr constructor does not touch the hardware;
+ *    init() sets the default 9600 baud
+ *  - same methods as ::UartCore, except buffered transmit
+ *    (transmit always synchronous)
+ */
+namespace slot {
+
+template<int SLOT>
+class UartCore {
+   enum {
+      RD_DATA_REG = 0,
+      DVSR_REG = 1,
+      WR_DATA_REG = 2,
+      RM_RD_DATA_REG = 3
+   };
+   enum {
+      TX_FULL_FIELD = 0x00000200,
+      RX_EMPT_FIELD = 0x00000100,
+      RX_DATA_FIELD = 0x000000ff
+   };
+public:
+   static constexpr uint32_t base_addr = get_slot_addr(BRIDGE_BASE, SLOT);
+
+   constexpr UartCore() {
+   }
+
+   void init() {
+      set_baud_rate(9600);
+   }
+
+   void set_baud_rate(int baud) {
+      io_write(base_addr, DVSR_REG, SYS_CLK_FREQ * 1000000 / 16 / baud - 1);
+   }
+
+   int rx_fifo_empty() {
+      return ((int) (io_read(base_addr, RD_DATA_REG) & RX_EMPT_FIELD) >> 8);
+   }
+
+   int tx_fifo_full() {
+      return ((int) (io_read(base_addr, RD_DATA_REG) & TX_FULL_FIELD) >> 9);
+   }
+
+   void tx_byte(uint8_t byte) {
+      while (tx_fifo_full()) {
+      };  // busy waiting
+      io_write(base_addr, WR_DATA_REG, (uint32_t) byte);
+   }
+
+   int rx_byte() {
+      uint32_t data;
+
+      if (rx_fifo_empty())
+         return (-1);
+      data = io_read(base_addr, RD_DATA_REG) & RX_DATA_FIELD;
+      io_write(base_addr, RM_RD_DATA_REG, 0); //dummy write to remove data
+      return ((int) data);
+   }
+
+   void disp(char ch) {
+      tx_byte(ch);
+   }
+
+   void disp(const char *str) {
+      while ((uint8_t) *str) {
+         tx_byte(*str);
+         str++;
+      }
+   }
+
+   void disp(int n, int base, int len) {
+      char buf[::UartCore::INT_STR_LEN];
+      disp(::UartCore::int2str(n, base, len, buf));
+   }
+
+   void disp(int n, int base) {
+      disp(n, base, 0);
+   }
+
+   void disp(int n) {
+      disp(n, 10, 0);
+   }
+
+   void disp(double f, int digit) {
+      char buf[::UartCore::DBL_STR_LEN];
+      disp(::UartCore::dbl2str(f, digit, buf));
+   }
+
+   void disp(double f) {
+      disp(f, 3);
+   }
+};
+
+} // namespace slot
+
 #endif  // _UART_CORE_H_INCLUDED
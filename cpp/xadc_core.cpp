@@ -0,0 +1,40 @@
+/*****************************************************************//**
+ * @file xadc_core.cpp
+ *
+ * @brief implementation of XadcCore class
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include "xadc_core.h"
+
+XadcCore::XadcCore(uint32_t core_base_addr) {
+   base_addr = core_base_addr;
+}
+XadcCore::~XadcCore() {
+}
+
+uint16_t XadcCore::read_raw(int n) {
+   return ((uint16_t) io_read(base_addr, n));
+}
+
+int XadcCore::read_adc_mv(int n) {
+   return (adc_to_mv(read_raw(ADC_0_REG + (n & 0x03))));
+}
+
+int XadcCore::read_vcc_mv() {
+   return (vcc_to_mv(read_raw(VCC_REG)));
+}
+
+int32_t XadcCore::read_temp_q7() {
+   return (tmp_to_q7(read_raw(TMP_REG)));
+}
+
+void XadcCore::snapshot(XadcSnap *s) {
+   s->adc[0] = (uint16_t) io_read(base_addr, ADC_0_REG);
+   s->adc[1] = (uint16_t) io_read(base_addr, ADC_0_REG + 1);
+   s->adc[2] = (uint16_t) io_read(base_addr, ADC_0_REG + 2);
+   s->adc[3] = (uint16_t) io_read(base_addr, ADC_0_REG + 3);
+   s->tmp = (uint16_t) io_read(base_addr, TMP_REG);
+   s->vcc = (uint16_t) io_read(base_addr, VCC_REG);
+}
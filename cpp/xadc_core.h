@@ -0,0 +1,117 @@
+/*****************************************************************//**
+ * @file xadc_core.h
+ *
+ * @brief XADC core driver (FPGA die temperature, VCCINT, aux inputs)
+ *
+ * Detailed description:
+ *  - the core scans its channels continuously and keeps the latest
+ *    conversion of each in a register; a reading is one bus access
+ *  - register value: 12-bit conversion in bits 15-4
+ *  - integer conversions only:
+ *      die temperature in 1/128 C (Q7, as Adt7420)
+ *      VCCINT and aux inputs in mV
+ *  - snapshot(): all six registers read back to back
+ *  - die temperature is well above ambient (self-heating) but tracks
+ *    it; usable as a fast cross-check/backup of a board sensor once
+ *    the offset is known
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#ifndef _XADC_CORE_H_INCLUDED
+#define _XADC_CORE_H_INCLUDED
+
+#include "chu_init.h"
+
+/**
+ * raw readout of all channels
+ */
+struct XadcSnap {
+   uint16_t adc[4];      // aux inputs (Nexys4 DDR JXADC header)
+   uint16_t tmp;         // die temperature
+   uint16_t vcc;         // VCCINT
+};
+
+/**
+ * XADC core driver
+ *
+ */
+class XadcCore {
+public:
+   /**
+    * register map
+    *
+    */
+   enum {
+      ADC_0_REG = 0,   /**< aux input 0 (adc1-3 at 1-3) */
+      TMP_REG = 4,     /**< die temperature */
+      VCC_REG = 5      /**< VCCINT */
+   };
+   /**
+    * constructor.
+    *
+    */
+   XadcCore(uint32_t core_base_addr);
+   ~XadcCore();                  // not used
+
+   /* methods */
+   /**
+    * read a channel register
+    * @param n register (ADC_0_REG+i, TMP_REG, VCC_REG)
+    * @return register value (conversion in bits 15-4)
+    */
+   uint16_t read_raw(int n);
+
+   /**
+    * read an aux input (unipolar, 0 to 1 V)
+    * @param n aux input 0-3
+    * @return voltage in mV
+    */
+   int read_adc_mv(int n);
+
+   /**
+    * read VCCINT
+    * @return voltage in mV
+    */
+   int read_vcc_mv();
+
+   /**
+    * read the die temperature
+    * @return temperature in 1/128 C
+    */
+   int32_t read_temp_q7();
+
+   /**
+    * read all channel registers back to back
+    * @param s readout
+    */
+   void snapshot(XadcSnap *s);
+
+   /**
+    * die temperature register to 1/128 C
+    *  - T = code * 503.975 / 4096 - 273.15 (code: bits 15-4)
+    */
+   static int32_t tmp_to_q7(uint16_t raw) {
+      // 503.975 * 128 = 64508.8; 273.15 * 128 = 34963.2
+      return ((int32_t) (((uint32_t) raw * 64509u) >> 16) - 34963);
+   }
+
+   /**
+    * supply register (VCCINT) to mV: full scale 3 V
+    */
+   static int vcc_to_mv(uint16_t raw) {
+      return ((int) (((uint32_t) raw * 3000u + 0x8000u) >> 16));
+   }
+
+   /**
+    * aux input register to mV: full scale 1 V
+    */
+   static int adc_to_mv(uint16_t raw) {
+      return ((int) (((uint32_t) raw * 1000u + 0x8000u) >> 16));
+   }
+
+private:
+   uint32_t base_addr;
+};
+
+#endif  // _XADC_CORE_H_INCLUDED
@@ -0,0 +1,968 @@
+/*****************************************************************//**
+ * @file chu_io_emu.cpp
+ *
+ * @brief implementation of the host-side emulated MMIO bus
+ *
+ * Each model mirrors the register decoding of its HDL counterpart;
+ * internal state is brought up to date lazily (from the virtual
+ * clock) when the core is accessed.
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <deque>
+#include <string>
+#include <algorithm>
+#include "chu_io_map.h"
+#include "chu_io_emu.h"
+
+/**********************************************************************
+ * virtual clock
+ *********************************************************************/
+static uint64_t emu_clk = 0;          // current time in system clocks
+static uint32_t emu_cost = 10;        // # clocks per bus access
+
+/**********************************************************************
+ * core model base class
+ *********************************************************************/
+class EmuCore {
+public:
+   virtual ~EmuCore() {
+   }
+   virtual uint32_t read(int reg) = 0;
+   virtual void write(int reg, uint32_t data) = 0;
+};
+
+/**********************************************************************
+ * slot 0: chu_timer
+ *  - 48-bit counter; go/clear in ctrl register (addr 2)
+ *********************************************************************/
+class EmuTimer: public EmuCore {
+public:
+   EmuTimer() {
+      count = 0;
+      stamp = 0;
+      go = 0;
+   }
+   uint32_t read(int reg) {
+      update();
+      if ((reg & 0x01) == 0)
+         return ((uint32_t) count);
+      else
+         return ((uint32_t) (count >> 32) & 0x0000ffff);
+   }
+   void write(int reg, uint32_t data) {
+      if ((reg & 0x03) != 2)
+         return;
+      update();
+      go = data & 0x01;
+      if (data & 0x02)
+         count = 0;
+   }
+private:
+   uint64_t count;   // counter value at stamp
+   uint64_t stamp;   // virtual time of last update
+   int go;
+   void update() {
+      if (go)
+         count = (count + (emu_clk - stamp)) & 0x0000ffffffffffffULL;
+      stamp = emu_clk;
+   }
+};
+
+/**********************************************************************
+ * slot 1: chu_uart
+ *  - 2^8-word tx/rx fifos
+ *  - a byte (start + 8 data + stop) leaves the tx fifo every
+ *    16*(dvsr+1)*10 clocks
+ *********************************************************************/
+class EmuUart: public EmuCore {
+public:
+   enum {
+      FIFO_DEPTH = 256
+   };
+   EmuUart() {
+      dvsr = 0;
+      tx_head = tx_num = 0;
+      rx_head = rx_num = 0;
+      tx_done = 0;
+      tx_count = 0;
+      out = stdout;
+   }
+   uint32_t read(int reg) {
+      uint32_t rd;
+
+      (void) reg;
+      update();
+      rd = rx_num ? rx_fifo[rx_head] : 0;
+      if (rx_num == 0)
+         rd |= 0x00000100;
+      if (tx_num == FIFO_DEPTH)
+         rd |= 0x00000200;
+      return (rd);
+   }
+   void write(int reg, uint32_t data) {
+      update();
+      switch (reg & 0x03) {
+      case 1:
+         dvsr = data & 0x07ff;
+         break;
+      case 2:
+         if (tx_num == FIFO_DEPTH)
+            break;    // fifo full; data lost as in hardware
+         if (tx_num == 0)
+            tx_done = emu_clk + byte_time();
+         tx_fifo[(tx_head + tx_num) % FIFO_DEPTH] = (uint8_t) data;
+         tx_num++;
+         tx_count++;
+         break;
+      case 3:
+         if (rx_num) {
+            rx_head = (rx_head + 1) % FIFO_DEPTH;
+            rx_num--;
+         }
+         break;
+      default:
+         break;
+      }
+   }
+   void rx(uint8_t byte) {
+      if (rx_num == FIFO_DEPTH)
+         return;
+      rx_fifo[(rx_head + rx_num) % FIFO_DEPTH] = byte;
+      rx_num++;
+   }
+   // send out everything still in the tx fifo
+   void flush() {
+      while (tx_num)
+         shift_out();
+      if (out)
+         fflush(out);
+   }
+   FILE *out;
+   uint64_t tx_count;
+private:
+   uint32_t dvsr;
+   uint8_t tx_fifo[FIFO_DEPTH], rx_fifo[FIFO_DEPTH];
+   int tx_head, tx_num, rx_head, rx_num;
+   uint64_t tx_done;  // virtual time the head byte is shifted out
+   uint64_t byte_time() {
+      return (16 * (uint64_t) (dvsr + 1) * 10);
+   }
+   void shift_out() {
+      if (out)
+         fputc(tx_fifo[tx_head], out);
+      tx_head = (tx_head + 1) % FIFO_DEPTH;
+      tx_num--;
+   }
+   void update() {
+      while (tx_num && emu_clk >= tx_done) {
+         shift_out();
+         tx_done = tx_done + byte_time();
+      }
+   }
+};
+
+/**********************************************************************
+ * slot 2: chu_gpo; slot 3: chu_gpi
+ *********************************************************************/
+class EmuGpo: public EmuCore {
+public:
+   EmuGpo() {
+      dout = 0;
+   }
+   uint32_t read(int reg) {
+      (void) reg;
+      return (0);
+   }
+   void write(int reg, uint32_t data) {
+      (void) reg;
+      dout = data;
+   }
+   uint32_t dout;
+};
+
+class EmuGpi: public EmuCore {
+public:
+   EmuGpi() {
+      din = 0;
+   }
+   uint32_t read(int reg) {
+      (void) reg;
+      return (din);
+   }
+   void write(int reg, uint32_t data) {
+      (void) reg;
+      (void) data;
+   }
+   uint32_t din;
+};
+
+/**********************************************************************
+ * slot 6: chu_io_pwm_core
+ *  - addr 0: divisor; addr 0x10-0x1f: duty cycles
+ *********************************************************************/
+class EmuPwm: public EmuCore {
+public:
+   EmuPwm() {
+      dvsr = 0;
+      memset(duty, 0, sizeof(duty));
+   }
+   uint32_t read(int reg) {
+      (void) reg;
+      return (0);
+   }
+   void write(int reg, uint32_t data) {
+      if (reg & 0x10)
+         duty[reg & 0x0f] = data & 0x07ff;
+      else if (reg == 0)
+         dvsr = data;
+   }
+   uint32_t dvsr;
+   uint32_t duty[16];
+};
+
+/**********************************************************************
+ * slot 7: chu_debounce_core
+ *  - addr 0: raw input; addr 1: debounced input
+ *  - debounced output follows the input after it has been stable
+ *    for 3 ticks of the 2^20-clock (~10 ms) debounce counter
+ *********************************************************************/
+class EmuDebounce: public EmuCore {
+public:
+   enum {
+      DB_CLOCKS = 3 << 20
+   };
+   EmuDebounce() {
+      din = 0;
+      db_prev = 0;
+      change = 0;
+   }
+   uint32_t read(int reg) {
+      if (reg & 0x01)
+         return (db());
+      return (din);
+   }
+   void write(int reg, uint32_t data) {
+      (void) reg;
+      (void) data;
+   }
+   void set(uint32_t btn) {
+      db_prev = db();
+      din = btn;
+      change = emu_clk;
+   }
+private:
+   uint32_t din, db_prev;
+   uint64_t change;   // virtual time of last input change
+   uint32_t db() {
+      return ((emu_clk - change >= DB_CLOCKS) ? din : db_prev);
+   }
+};
+
+/**********************************************************************
+ * slot 8: chu_led_mux_core
+ *********************************************************************/
+class EmuLedMux: public EmuCore {
+public:
+   EmuLedMux() {
+      d[0] = d[1] = 0;
+   }
+   uint32_t read(int reg) {
+      (void) reg;
+      return (0);
+   }
+   void write(int reg, uint32_t data) {
+      d[reg & 0x01] = data;
+   }
+   uint32_t d[2];
+};
+
+/**********************************************************************
+ * i2c slave device model
+ *********************************************************************/
+class EmuI2cDev {
+public:
+   EmuI2cDev(uint8_t dev_addr, uint32_t freq = 1000000) {
+      addr = dev_addr;
+      max_freq = freq;
+   }
+   virtual ~EmuI2cDev() {
+   }
+   virtual void start(int rd) = 0;       // addressed with r/w bit
+   virtual int write(uint8_t data) = 0;  // return 0 for ack
+   virtual uint8_t read() = 0;
+   uint8_t addr;
+   uint32_t max_freq;   // fastest scl the device follows
+};
+
+/**********************************************************************
+ * ADT7420 temperature sensor
+ *  - register 0x00/0x01: temperature msb/lsb
+ *  - register 0x03: configuration (bit 7: 16-bit resolution;
+ *    bits 6-5: 11 for shutdown)
+ *  - register 0x0b: id (0xcb)
+ *  - 1st byte of a write sets the address pointer; the pointer is
+ *    retained between transactions and auto-increments within one
+ *  - i2c fast mode (400K Hz) at most
+ *********************************************************************/
+class EmuAdt7420: public EmuI2cDev {
+public:
+   EmuAdt7420() : EmuI2cDev(0x4b, 400000) {
+      memset(reg, 0, sizeof(reg));
+      reg[0x04] = 0x20;   // T_high default 64 C
+      reg[0x06] = 0x05;   // T_low default 10 C
+      reg[0x08] = 0x49;   // T_crit default 147 C
+      reg[0x0a] = 0x05;   // T_hyst default 5 C
+      reg[0x0b] = 0xcb;   // id
+      ptr = 0;
+      idx = 0;
+      first = 0;
+      temp_mC = 25000;
+      convert();
+   }
+   void start(int rd) {
+      (void) rd;
+      idx = 0;
+      first = 1;
+      convert();
+   }
+   int write(uint8_t data) {
+      if (first) {
+         ptr = data;
+         first = 0;
+      } else {
+         if (((ptr + idx) & 0x3f) < (int) sizeof(reg))
+            reg[(ptr + idx) & 0x3f] = data;
+         idx++;
+      }
+      return (0);
+   }
+   uint8_t read() {
+      uint8_t data;
+
+      data = reg[(ptr + idx) % sizeof(reg)];
+      idx++;
+      return (data);
+   }
+   int32_t temp_mC;
+private:
+   uint8_t reg[0x30];
+   int ptr, idx, first;
+   // latch the temperature register (unless in shutdown)
+   void convert() {
+      int32_t code;
+
+      if ((reg[0x03] & 0x60) == 0x60)
+         return;
+      if (reg[0x03] & 0x80)  // 16-bit: 1/128 C per lsb
+         code = (temp_mC * 128 + (temp_mC >= 0 ? 500 : -500)) / 1000;
+      else                   // 13-bit: 1/16 C per lsb, in bits 15-3
+         code = ((temp_mC * 16 + (temp_mC >= 0 ? 500 : -500)) / 1000) * 8;
+      reg[0x00] = (uint8_t) (code >> 8);
+      reg[0x01] = (uint8_t) code;
+   }
+};
+
+/**********************************************************************
+ * slot 10: chu_i2c_core
+ *  - addr 0 (wr): divisor; addr 1 (wr): command/data
+ *  - rd: {ack, ready, dout}
+ *  - command duration derived from the i2c_master fsm
+ *    (each phase lasts dvsr+1 clocks; "half" phases 2*dvsr+1)
+ *  - a device addressed above its max_freq does not ack
+ *  - fault injection: EMU_I2C_NACK (no device acks its address),
+ *    EMU_I2C_HANG (scl held low; the current command never ends)
+ *********************************************************************/
+class EmuI2c: public EmuCore {
+public:
+   EmuI2c() {
+      dvsr = 0;
+      busy_until = 0;
+      hold = 0;
+      addr_phase = 0;
+      dev = 0;
+      dout = 0;
+      ack = 0;
+      fault = EMU_I2C_OK;
+   }
+   ~EmuI2c() {
+      for (size_t i = 0; i < devs.size(); i++)
+         delete devs[i];
+   }
+   uint32_t read(int reg) {
+      (void) reg;
+      return ((ack << 9) | (ready() << 8) | dout);
+   }
+   void write(int reg, uint32_t data) {
+      uint64_t q, h;
+      int cmd;
+
+      if ((reg & 0x01) == 0) {
+         dvsr = data & 0xffff;
+         return;
+      }
+      if (!ready())
+         return;    // fsm ignores commands while busy
+      q = (uint64_t) dvsr + 1;
+      h = 2 * (uint64_t) dvsr + 1;
+      cmd = (data >> 8) & 0x07;
+      if (!hold) {
+         if (cmd != 0)
+            return;  // only start accepted in idle state
+         hold = 1;
+         addr_phase = 1;
+         busy_until = emu_clk + h + q;
+         return;
+      }
+      switch (cmd) {
+      case 0:      // start
+      case 4:      // restart
+         addr_phase = 1;
+         busy_until = emu_clk + h + h + q;
+         break;
+      case 3:      // stop
+         hold = 0;
+         dev = 0;
+         busy_until = emu_clk + 2 * h;
+         break;
+      case 1:      // write
+         ack = wr_byte((uint8_t) data);
+         dout = (uint8_t) data;
+         busy_until = emu_clk + 37 * q;
+         break;
+      case 2:      // read
+         dout = dev ? dev->read() : 0xff;
+         ack = data & 0x01;   // master's own ack/nack bit
+         busy_until = emu_clk + 37 * q;
+         break;
+      default:
+         break;
+      }
+   }
+   void attach(EmuI2cDev *d) {
+      devs.push_back(d);
+   }
+   int fault;         // EMU_I2C_xxx
+   EmuI2cDev *find(uint8_t a) {
+      if (fault == EMU_I2C_NACK)
+         return (0);
+      for (size_t i = 0; i < devs.size(); i++)
+         if (devs[i]->addr == a)
+            return (devs[i]);
+      return (0);
+   }
+private:
+   uint32_t dvsr;
+   uint64_t busy_until;
+   int hold;          // bus owned (between start and stop)
+   int addr_phase;    // next write is an address byte
+   EmuI2cDev *dev;    // addressed device
+   uint32_t dout, ack;
+   std::vector<EmuI2cDev *> devs;
+   uint32_t ready() {
+      if (fault == EMU_I2C_HANG)
+         return (0);
+      return (emu_clk >= busy_until) ? 1 : 0;
+   }
+   // scl period is 4 phases of dvsr+1 clocks
+   uint32_t scl_freq() {
+      return ((uint32_t) ((uint64_t) SYS_CLK_FREQ * 1000000 / (4 * ((uint64_t) dvsr + 1))));
+   }
+   // return sampled ack bit (0: ack; 1: no ack)
+   uint32_t wr_byte(uint8_t data) {
+      if (addr_phase) {
+         addr_phase = 0;
+         dev = find(data >> 1);
+         if (dev && scl_freq() > dev->max_freq)
+            dev = 0;   // too fast: address not recognized
+         if (!dev)
+            return (1);
+         dev->start(data & 0x01);
+         return (0);
+      }
+      if (!dev)
+         return (1);
+      return (dev->write(data) ? 1 : 0);
+   }
+};
+
+/**********************************************************************
+ * slot 5: chu_xadc_core
+ *  - registers hold the latest conversion of each channel (12 bits
+ *    in bits 15-4); the continuous scan is not modeled, a stimulus
+ *    change is visible on the next read
+ *  - read map: 0-3 aux inputs, 4 die temperature, others VCCINT
+ *********************************************************************/
+class EmuXadc: public EmuCore {
+public:
+   EmuXadc() {
+      die_mC = 45000;
+      vcc_mV = 1000;
+      for (int i = 0; i < 4; i++)
+         adc_mV[i] = 0;
+   }
+   uint32_t read(int reg) {
+      switch (reg & 0x07) {
+      case 0: case 1: case 2: case 3:
+         return (code(adc_mV[reg & 0x03], 1000));
+      case 4:
+         // code = (T + 273.15) * 4096 / 503.975
+         return (conv(((int64_t) die_mC + 273150) * 4096, 503975));
+      default:
+         return (code(vcc_mV, 3000));
+      }
+   }
+   void write(int reg, uint32_t data) {
+      (void) reg;
+      (void) data;
+   }
+   int32_t die_mC;
+   int32_t vcc_mV;
+   int32_t adc_mV[4];
+private:
+   // rounded 12-bit conversion in bits 15-4
+   static uint32_t conv(int64_t num, int64_t den) {
+      int64_t c = (num + den / 2) / den;
+      if (c < 0)
+         c = 0;
+      if (c > 4095)
+         c = 4095;
+      return ((uint32_t) c << 4);
+   }
+   static uint32_t code(int32_t mV, int32_t full_mV) {
+      return (conv((int64_t) mV * 4096, full_mV));
+   }
+};
+
+/**********************************************************************
+ * ADXL362 accelerometer (spi slave)
+ *  - 1st byte command: 0x0a write register, 0x0b read register,
+ *    0x0d read FIFO; 2nd byte register address (auto-increments)
+ *  - registers: ids 0x00-0x02, FIFO_ENTRIES 0x0c-0x0d, XDATA-ZDATA
+ *    0x0e-0x13, SOFT_RESET 0x1f, FIFO_CONTROL 0x28, FILTER_CTL 0x2c
+ *    (bits 2-0 odr: 12.5 Hz * 2^odr), POWER_CTL 0x2d
+ *  - in measurement mode an x/y/z set is taken every 1/odr and
+ *    pushed into the FIFO if enabled (stream mode: oldest entries
+ *    dropped when full)
+ *  - acceleration from the stimulus (mg); the vibration amplitude is
+ *    added to x with alternating sign
+ *  - 8M Hz sclk at most; faster transfers read 0xff
+ *********************************************************************/
+class EmuAdxl362 {
+public:
+   enum {
+      FIFO_DEPTH = 512
+   };
+   EmuAdxl362() {
+      acc[0] = acc[1] = 0;
+      acc[2] = 1000;   // flat on the table: 1 g on z
+      vib = 0;
+      reset();
+   }
+   void reset() {
+      memset(reg, 0, sizeof(reg));
+      reg[0x00] = 0xad;
+      reg[0x01] = 0x1d;
+      reg[0x02] = 0xf2;
+      reg[0x2c] = 0x13;
+      fifo.clear();
+      n = -1;
+      cmd = addr = 0;
+      hi = 0;
+      flip = 1;
+      next_t = 0;
+   }
+   void select(int on) {
+      update();
+      n = on ? 0 : -1;
+   }
+   uint8_t xfer(uint8_t mosi) {
+      uint8_t miso = 0;
+
+      if (n < 0)
+         return (0xff);
+      if (n == 0)
+         cmd = mosi;
+      else if (cmd == 0x0d)
+         miso = fifo_byte();
+      else if (n == 1)
+         addr = mosi;
+      else if (cmd == 0x0b)
+         miso = reg[addr++ & 0x3f];
+      else if (cmd == 0x0a)
+         write_reg(addr++ & 0x3f, mosi);
+      n++;
+      return (miso);
+   }
+   int32_t acc[3];   // mg
+   int32_t vib;      // mg
+private:
+   uint8_t reg[64];
+   std::deque<uint16_t> fifo;
+   int n;            // byte # in transaction; -1: not selected
+   uint8_t cmd, addr;
+   int hi;           // FIFO read: next byte is the msb of fifo.front()
+   int flip;         // vibration sign
+   uint64_t next_t;  // virtual time of the next sample
+   uint64_t period() {
+      return ((uint64_t) SYS_CLK_FREQ * 80000 >> (reg[0x2c] & 0x07));
+   }
+   void write_reg(int a, uint8_t d) {
+      if (a == 0x1f) {
+         if (d == 0x52)
+            reset();
+         return;
+      }
+      if (a >= 0x1f)
+         reg[a] = d;
+      if (a == 0x2d && (d & 0x03) == 0x02)
+         next_t = emu_clk + period();   // measurement starts
+   }
+   uint8_t fifo_byte() {
+      uint8_t b;
+
+      if (fifo.empty())
+         return (0);
+      if (!hi) {
+         hi = 1;
+         return ((uint8_t) fifo.front());
+      }
+      b = (uint8_t) (fifo.front() >> 8);
+      fifo.pop_front();
+      hi = 0;
+      set_entries();
+      return (b);
+   }
+   void set_entries() {
+      reg[0x0c] = (uint8_t) fifo.size();
+      reg[0x0d] = (uint8_t) (fifo.size() >> 8);
+   }
+   void update() {
+      if ((reg[0x2d] & 0x03) != 0x02)
+         return;
+      while (emu_clk >= next_t) {
+         int32_t v[3] = {acc[0] + vib * flip, acc[1], acc[2]};
+         flip = -flip;
+         for (int i = 0; i < 3; i++) {
+            int32_t d = std::min(std::max(v[i], (int32_t) -2048), (int32_t) 2047);
+            reg[0x0e + 2 * i] = (uint8_t) d;
+            reg[0x0f + 2 * i] = (uint8_t) (d >> 8);
+            if (reg[0x28] & 0x03) {
+               if (fifo.size() == FIFO_DEPTH) {
+                  fifo.pop_front();
+                  hi = 0;
+               }
+               fifo.push_back((uint16_t) ((i << 14) | (d & 0x3fff)));
+            }
+         }
+         set_entries();
+         next_t += period();
+      }
+   }
+};
+
+/**********************************************************************
+ * slot 9: chu_spi_core (one slave select: ADXL362)
+ *  - a write to reg 2 shifts a byte out and in; ready again after
+ *    16 * (dvsr + 1) clocks (sclk period 2 * (dvsr + 1))
+ *  - read: bit 8 ready, bits 7-0 received byte
+ *********************************************************************/
+class EmuSpi: public EmuCore {
+public:
+   EmuSpi() {
+      ctrl = 0x200;
+      ss_n = 1;
+      rx = 0;
+      done = 0;
+   }
+   uint32_t read(int reg) {
+      (void) reg;
+      return ((emu_clk >= done ? 0x100 : 0) | rx);
+   }
+   void write(int reg, uint32_t data) {
+      switch (reg & 0x03) {
+      case 1:
+         if ((data & 0x01) != ss_n)
+            acl.select(!(data & 0x01));
+         ss_n = data & 0x01;
+         break;
+      case 2:
+         if (emu_clk < done)
+            break;   // busy: start ignored
+         rx = ss_n ? 0xff : acl.xfer((uint8_t) data);
+         if (freq() > 8000000)
+            rx = 0xff;
+         done = emu_clk + 16 * (uint64_t) ((ctrl & 0xffff) + 1);
+         break;
+      case 3:
+         ctrl = data;
+         break;
+      default:
+         break;
+      }
+   }
+   EmuAdxl362 acl;
+private:
+   uint32_t ctrl;
+   uint32_t ss_n;
+   uint32_t rx;
+   uint64_t done;    // virtual time the current byte completes
+   uint32_t freq() {
+      return ((uint32_t) (SYS_CLK_FREQ * 1000000 / (2 * ((ctrl & 0xffff) + 1))));
+   }
+};
+
+/**********************************************************************
+ * io subsystem: slot table, stimulus script
+ *********************************************************************/
+struct EmuEvent {
+   uint64_t at;        // virtual time in clocks
+   std::string cmd;
+   std::string arg;
+};
+
+class EmuSystem {
+public:
+   EmuSystem() {
+      for (int i = 0; i < 64; i++)
+         slot[i] = 0;
+      slot[S0_SYS_TIMER] = &timer;
+      slot[S1_UART1] = &uart;
+      slot[S2_LED] = &gpo;
+      slot[S3_SW] = &gpi;
+      slot[S5_XDAC] = &xadc;
+      slot[S6_PWM] = &pwm;
+      slot[S7_BTN] = &btn;
+      slot[S8_SSEG] = &sseg;
+      slot[S9_SPI] = &spi;
+      slot[S10_I2C] = &i2c;
+      adt7420 = new EmuAdt7420();
+      i2c.attach(adt7420);
+      next_ev = 0;
+   }
+   EmuTimer timer;
+   EmuUart uart;
+   EmuGpo gpo;
+   EmuGpi gpi;
+   EmuXadc xadc;
+   EmuPwm pwm;
+   EmuDebounce btn;
+   EmuLedMux sseg;
+   EmuSpi spi;
+   EmuI2c i2c;
+   EmuAdt7420 *adt7420;
+   EmuCore *slot[64];
+   std::vector<EmuEvent> events;
+   size_t next_ev;
+
+   void poll_events() {
+      while (next_ev < events.size() && events[next_ev].at <= emu_clk) {
+         apply(events[next_ev]);
+         next_ev++;
+      }
+   }
+private:
+   void apply(const EmuEvent &ev) {
+      if (ev.cmd == "sw")
+         gpi.din = (uint32_t) strtoul(ev.arg.c_str(), 0, 0);
+      else if (ev.cmd == "btn")
+         btn.set((uint32_t) strtoul(ev.arg.c_str(), 0, 0));
+      else if (ev.cmd == "temp")
+         adt7420->temp_mC = (int32_t) strtol(ev.arg.c_str(), 0, 0);
+      else if (ev.cmd == "die")
+         xadc.die_mC = (int32_t) strtol(ev.arg.c_str(), 0, 0);
+      else if (ev.cmd == "vcc")
+         xadc.vcc_mV = (int32_t) strtol(ev.arg.c_str(), 0, 0);
+      else if (ev.cmd == "adc") {
+         char *p;
+         long ch = strtol(ev.arg.c_str(), &p, 0);
+         xadc.adc_mV[ch & 0x03] = (int32_t) strtol(p, 0, 0);
+      } else if (ev.cmd == "acl") {
+         char *p = (char *) ev.arg.c_str();
+         for (int i = 0; i < 3; i++)
+            spi.acl.acc[i] = (int32_t) strtol(p, &p, 0);
+      } else if (ev.cmd == "vib")
+         spi.acl.vib = (int32_t) strtol(ev.arg.c_str(), 0, 0);
+      else if (ev.cmd == "i2c")
+         i2c.fault = (ev.arg == "nack") ? EMU_I2C_NACK :
+                     (ev.arg == "hang") ? EMU_I2C_HANG : EMU_I2C_OK;
+      else if (ev.cmd == "rx")
+         for (size_t i = 0; i < ev.arg.size(); i++)
+            uart.rx((uint8_t) ev.arg[i]);
+      else if (ev.cmd == "quit") {
+         uart.flush();
+         exit(0);
+      }
+   }
+};
+
+static EmuSystem &emu();
+
+// send out uart data still queued when the program exits
+static void emu_exit() {
+   emu().uart.flush();
+}
+
+static EmuSystem &emu() {
+   static EmuSystem sys;
+   static int loaded = 0;
+
+   if (!loaded) {
+      const char *path = getenv("CHU_EMU_SCRIPT");
+      const char *cost = getenv("CHU_EMU_ACCESS_COST");
+      loaded = 1;
+      atexit(emu_exit);
+      if (cost)
+         emu_cost = (uint32_t) strtoul(cost, 0, 0);
+      if (path)
+         emu_load_script(path);
+   }
+   return (sys);
+}
+
+// decode byte address into slot core and register offset
+static EmuCore *decode(uint32_t base_addr, uint32_t offset, int *reg) {
+   uint32_t word;
+
+   word = (base_addr + 4 * offset - BRIDGE_BASE) >> 2;
+   if (word >= 64 * 32)
+      return (0);        // outside mmio space (e.g., video)
+   *reg = word & 0x1f;
+   return (emu().slot[word >> 5]);
+}
+
+/**********************************************************************
+ * C interface
+ *********************************************************************/
+uint32_t emu_io_read(uint32_t base_addr, uint32_t offset) {
+   EmuCore *core;
+   int reg;
+
+   emu_clk += emu_cost;
+   emu().poll_events();
+   core = decode(base_addr, offset, &reg);
+   return (core ? core->read(reg) : 0);
+}
+
+void emu_io_write(uint32_t base_addr, uint32_t offset, uint32_t data) {
+   EmuCore *core;
+   int reg;
+
+   emu_clk += emu_cost;
+   emu().poll_events();
+   core = decode(base_addr, offset, &reg);
+   if (core)
+      core->write(reg, data);
+}
+
+uint64_t emu_clock() {
+   return (emu_clk);
+}
+
+void emu_advance(uint64_t clocks) {
+   emu_clk += clocks;
+   emu().poll_events();
+}
+
+void emu_set_access_cost(uint32_t clocks) {
+   emu_cost = clocks;
+}
+
+void emu_set_sw(uint32_t sw) {
+   emu().gpi.din = sw;
+}
+
+void emu_set_btn(uint32_t btn) {
+   emu().btn.set(btn);
+}
+
+void emu_set_temp(int32_t mC) {
+   emu().adt7420->temp_mC = mC;
+}
+
+void emu_set_die_temp(int32_t mC) {
+   emu().xadc.die_mC = mC;
+}
+
+void emu_set_adc_mv(int ch, int32_t mV) {
+   if (ch < 0)
+      emu().xadc.vcc_mV = mV;
+   else
+      emu().xadc.adc_mV[ch & 0x03] = mV;
+}
+
+void emu_set_accel(int32_t x, int32_t y, int32_t z, int32_t vib) {
+   emu().spi.acl.acc[0] = x;
+   emu().spi.acl.acc[1] = y;
+   emu().spi.acl.acc[2] = z;
+   emu().spi.acl.vib = vib;
+}
+
+void emu_i2c_fault(int mode) {
+   emu().i2c.fault = mode;
+}
+
+void emu_uart_rx(uint8_t byte) {
+   emu().uart.rx(byte);
+}
+
+void emu_uart_set_output(FILE *fp) {
+   emu().uart.out = fp;
+}
+
+int emu_load_script(const char *path) {
+   FILE *fp;
+   char line[256];
+   EmuSystem &sys = emu();
+
+   fp = fopen(path, "r");
+   if (!fp)
+      return (-1);
+   while (fgets(line, sizeof(line), fp)) {
+      char *p, *cmd, *arg;
+      EmuEvent ev;
+
+      p = strchr(line, '#');
+      if (p)
+         *p = '\0';
+      p = line + strlen(line);
+      while (p > line && (p[-1] == '\n' || p[-1] == '\r'))
+         *--p = '\0';
+      ev.at = strtoull(line, &p, 10) * SYS_CLK_FREQ * 1000;
+      cmd = p + strspn(p, " \t");
+      if (*cmd == '\0')
+         continue;
+      arg = cmd + strcspn(cmd, " \t");
+      if (*arg) {
+         *arg++ = '\0';
+         arg += strspn(arg, " \t");
+      }
+      ev.cmd = cmd;
+      ev.arg = arg;
+      sys.events.push_back(ev);
+   }
+   fclose(fp);
+   std::stable_sort(sys.events.begin() + sys.next_ev, sys.events.end(),
+         [](const EmuEvent &a, const EmuEvent &b) {return a.at < b.at;});
+   return (0);
+}
+
+uint32_t emu_led() {
+   return (emu().gpo.dout);
+}
+
+uint32_t emu_pwm_duty(int channel) {
+   return (emu().pwm.duty[channel & 0x0f]);
+}
+
+uint32_t emu_sseg(int high) {
+   return (emu().sseg.d[high ? 1 : 0]);
+}
+
+uint64_t emu_uart_tx_count() {
+   return (emu().uart.tx_count);
+}
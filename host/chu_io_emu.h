@@ -0,0 +1,195 @@
+/*****************************************************************//**
+ * @file chu_io_emu.h
+ *
+ * @brief host-side emulated MMIO bus for the "sampler" io subsystem
+ *
+ * Description:
+ *  - selected by defining _VENDOR_IO_ACCESS_USED (see chu_io_rw.h)
+ *  - io_read()/io_write() are routed to emu_io_read()/emu_io_write()
+ *  - address is decoded into slot # and register offset and
+ *    dispatched to a behavioral model of the core in that slot
+ *  - models follow the cores of mmio_sys_sampler.sv:
+ *      slot 0 timer, 1 uart, 2 gpo, 3 gpi, 5 xadc, 6 pwm,
+ *      7 debounce, 8 led mux, 9 spi (with an ADXL362 at ss 0),
+ *      10 i2c (with an ADT7420 at address 0x4b)
+ *  - unused/unmodeled slots read 0 and ignore writes
+ *  - a virtual clock (in SYS_CLK_FREQ clocks) replaces the real one;
+ *    every bus access advances it by a fixed access cost, so
+ *    busy-waiting drivers (sleep, tx_byte, i2c ready) make progress
+ *  - access cost can be preset by CHU_EMU_ACCESS_COST environment variable
+ *  - external stimulus (switches, buttons, temperature, rx data)
+ *    set by the emu_set_xxx() functions or by a script file named
+ *    in the CHU_EMU_SCRIPT environment variable
+ *
+ * Script format (one event per line, '#' starts a comment):
+ *    <time_ms> sw   <value>
+ *    <time_ms> btn  <value>
+ *    <time_ms> temp <milli-degree C>
+ *    <time_ms> die  <milli-degree C>          (xadc die temperature)
+ *    <time_ms> vcc  <mV>                      (xadc VCCINT)
+ *    <time_ms> adc  <input 0-3> <mV>          (xadc aux input)
+ *    <time_ms> acl  <x> <y> <z>               (ADXL362, mg)
+ *    <time_ms> vib  <mg>                      (ADXL362 x vibration)
+ *    <time_ms> i2c  <ok|nack|hang>
+ *    <time_ms> rx   <string>
+ *    <time_ms> quit
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#ifndef _CHU_IO_EMU_H_INCLUDED
+#define _CHU_IO_EMU_H_INCLUDED
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**********************************************************************
+ * bus access (used by io_read()/io_write() macros)
+ *********************************************************************/
+/**
+ * read an emulated io register.
+ * @param base_addr base address of an io core
+ * @param offset register word offset
+ * @return 32-bit data of the register
+ */
+uint32_t emu_io_read(uint32_t base_addr, uint32_t offset);
+
+/**
+ * write an emulated io register.
+ * @param base_addr base address of an io core
+ * @param offset register word offset
+ * @param data 32-bit data
+ */
+void emu_io_write(uint32_t base_addr, uint32_t offset, uint32_t data);
+
+/**********************************************************************
+ * virtual clock
+ *********************************************************************/
+/**
+ * current virtual time in system clocks (SYS_CLK_FREQ MHz)
+ */
+uint64_t emu_clock();
+
+/**
+ * advance the virtual clock
+ * @param clocks # system clocks to skip
+ */
+void emu_advance(uint64_t clocks);
+
+/**
+ * set # system clocks consumed by one bus access
+ * @param clocks access cost (default 10)
+ */
+void emu_set_access_cost(uint32_t clocks);
+
+/**********************************************************************
+ * external stimulus
+ *********************************************************************/
+/**
+ * set the slide switches (slot 3 gpi input)
+ * @param sw switch pattern
+ */
+void emu_set_sw(uint32_t sw);
+
+/**
+ * set the push buttons (slot 7 debounce input)
+ * @param btn button pattern
+ */
+void emu_set_btn(uint32_t btn);
+
+/**
+ * set the ambient temperature seen by the ADT7420 model
+ * @param mC temperature in milli-degree Celsius
+ */
+void emu_set_temp(int32_t mC);
+
+/**
+ * set the FPGA die temperature seen by the xadc model (default 45 C)
+ * @param mC temperature in milli-degree Celsius
+ */
+void emu_set_die_temp(int32_t mC);
+
+/**
+ * set an xadc input voltage
+ * @param ch aux input 0-3; -1 for VCCINT (default 1000 mV)
+ * @param mV voltage in mV
+ */
+void emu_set_adc_mv(int ch, int32_t mV);
+
+/**
+ * set the acceleration seen by the ADXL362 model
+ * @param x, y, z acceleration in mg (default 0, 0, 1000)
+ * @param vib vibration amplitude on x in mg (sign alternates
+ *        every sample)
+ */
+void emu_set_accel(int32_t x, int32_t y, int32_t z, int32_t vib);
+
+/**
+ * i2c fault modes
+ */
+enum {
+   EMU_I2C_OK = 0,     /**< normal operation */
+   EMU_I2C_NACK = 1,   /**< no device acks its address */
+   EMU_I2C_HANG = 2    /**< core never becomes ready (scl held low) */
+};
+
+/**
+ * inject an i2c fault (slot 10)
+ * @param mode EMU_I2C_xxx; EMU_I2C_OK clears the fault
+ */
+void emu_i2c_fault(int mode);
+
+/**
+ * push a byte into the uart receiver fifo
+ * @param byte received byte
+ */
+void emu_uart_rx(uint8_t byte);
+
+/**
+ * redirect uart transmitter output
+ * @param fp output stream (NULL discards the output)
+ */
+void emu_uart_set_output(FILE *fp);
+
+/**
+ * load and schedule a stimulus script
+ * @param path script file name
+ * @return 0: ok; -1: file cannot be opened
+ * @note CHU_EMU_SCRIPT is loaded automatically on first bus access
+ */
+int emu_load_script(const char *path);
+
+/**********************************************************************
+ * observation
+ *********************************************************************/
+/**
+ * value driven on the leds (slot 2 gpo output)
+ */
+uint32_t emu_led();
+
+/**
+ * duty cycle register of a pwm channel (slot 6)
+ * @param channel pwm channel
+ */
+uint32_t emu_pwm_duty(int channel);
+
+/**
+ * 7-seg data registers (slot 8)
+ * @param high 0: DATA_LOW_REG (right 4 digits); 1: DATA_HIGH_REG
+ */
+uint32_t emu_sseg(int high);
+
+/**
+ * total # bytes written into the uart transmitter fifo
+ */
+uint64_t emu_uart_tx_count();
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif  // _CHU_IO_EMU_H_INCLUDED
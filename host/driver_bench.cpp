@@ -0,0 +1,381 @@
+/*****************************************************************//**
+ * @file driver_bench.cpp
+ *
+ * @brief driver-level benchmark on the emulated MMIO bus
+ *
+ * Description:
+ *  - runs the hot driver operations against host/chu_io_emu.cpp
+ *  - per operation (mean of several calls) reports:
+ *      - bus accesses (io_stats_total(); _IO_STATS required)
+ *      - estimated cycles: virtual clock advance, i.e., bus access
+ *        cost plus time spent waiting on the modeled cores
+ *        (cpu-only work such as soft-float is not included)
+ *      - bytes emitted on the uart
+ *  - results compared against a committed baseline;
+ *    the run fails (exit 1) if any figure exceeds its baseline
+ *  - the firmware (main_sampler_test.cpp) is compiled in with
+ *    main() renamed, so the LIVE-mode iteration is the real one
+ *  - cpu-only operations (sample filters, trend) are timed on the host in
+ *    ns per call; informational only, not compared (host dependent;
+ *    on target use _PROFILE, scope "filter_step")
+ *
+ * Build and run from the repository root:
+ *    g++ -O2 -D_VENDOR_IO_ACCESS_USED -D_IO_STATS -Icpp -Ihost \
+ *        host/driver_bench.cpp host/chu_io_emu.cpp \
+ *        $(find cpp -name '*.cpp' ! -name main_sampler_test.cpp) \
+ *        -o driver_bench
+ *    ./driver_bench [baseline_file] [--update]
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#define main sampler_main
+#include "../cpp/main_sampler_test.cpp"
+#undef main
+
+#ifndef _IO_STATS
+#error "driver_bench requires _IO_STATS"
+#endif
+
+#define BENCH_REPS 8
+// every op starts at this phase of the timer counter (mod 2^25):
+// in the upper half, away from the TICK_WRAP_WINDOW re-read region
+#define BENCH_PHASE_MASK 0x01ffffffUL
+#define BENCH_PHASE 0x01000000UL
+#define CPU_BENCH_SAMPLES 1000000
+#define DEFAULT_BASELINE "host/driver_bench_baseline.txt"
+
+// slot-bound templates the firmware does not use (the system timer
+// and uart are runtime objects in chu_init.cpp); compiled and measured
+// here; no init(): the firmware owns these cores
+static CHU_CONSTINIT slot::TimerCore<S0_SYS_TIMER> slot_timer;
+static CHU_CONSTINIT slot::UartCore<S1_UART1> slot_uart;
+// every member compiled, including those no op calls
+template class slot::TimerCore<S0_SYS_TIMER>;
+template class slot::UartCore<S1_UART1>;
+template class slot::GpoCore<S2_LED>;
+template class slot::GpiCore<S3_SW>;
+template class slot::PwmCore<S6_PWM>;
+template class slot::DebounceCore<S7_BTN>;
+template class slot::SsegCore<S8_SSEG>;
+
+struct BenchResult {
+   std::string name;
+   uint64_t accesses;
+   uint64_t cycles;
+   uint64_t bytes;
+};
+
+// let the uart fifo drain and pending i2c commands finish; then move
+// the clock to BENCH_PHASE so that the figures do not depend on the
+// time left by earlier ops
+static void settle() {
+   uint32_t t;
+
+   emu_advance((uint64_t) SYS_CLK_FREQ * 1000 * 300);
+   t = now_tick32();
+   emu_advance((BENCH_PHASE - t) & BENCH_PHASE_MASK);
+}
+
+// run op BENCH_REPS times from a settled state; report mean per call
+template <typename F>
+static BenchResult measure(const char *name, F op) {
+   BenchResult r = {name, 0, 0, 0};
+   uint64_t clk, bytes;
+   uint32_t acc;
+   int i;
+
+   for (i = 0; i < BENCH_REPS; i++) {
+      settle();
+      io_stats_clear();
+      acc = io_stats_total();
+      clk = emu_clock();
+      bytes = emu_uart_tx_count();
+      op();
+      r.accesses += io_stats_total() - acc;
+      r.cycles += emu_clock() - clk;
+      r.bytes += emu_uart_tx_count() - bytes;
+   }
+   r.accesses = (r.accesses + BENCH_REPS / 2) / BENCH_REPS;
+   r.cycles = (r.cycles + BENCH_REPS / 2) / BENCH_REPS;
+   r.bytes = (r.bytes + BENCH_REPS / 2) / BENCH_REPS;
+   return (r);
+}
+
+static std::vector<BenchResult> run_all() {
+   std::vector<BenchResult> res;
+   uint8_t ptn[2][8] = {
+      {0xc0, 0xf9, 0xa4, 0xb0, 0x99, 0x92, 0x82, 0xf8},
+      {0xf8, 0x82, 0x92, 0x99, 0xb0, 0xa4, 0xf9, 0xc0}
+   };
+   uint8_t bytes[2];
+   bool rst = false, live = true, z = false;
+
+   res.push_back(measure("i2c_read_transaction", [&] {
+      i2c.read_transaction(0x4b, bytes, 2, 0);
+   }));
+   res.push_back(measure("i2c_write_transaction", [&] {
+      bytes[0] = 0x00;
+      i2c.write_transaction(0x4b, bytes, 1, 1);
+   }));
+   adt7420.init();
+   adt7420.read();    // pointer now at the temperature register
+   res.push_back(measure("adt7420_read_temp", [&] {
+      adt7420.read();
+   }));
+   i2c.set_freq(I2cCore::I2C_SPEED_FAST);
+   res.push_back(measure("adt7420_read_temp_400k", [&] {
+      adt7420.read();
+   }));
+   // failing sensor: bounded by retries and time-outs
+   emu_i2c_fault(EMU_I2C_NACK);
+   res.push_back(measure("adt7420_read_nack", [&] {
+      adt7420.read();
+   }));
+   emu_i2c_fault(EMU_I2C_HANG);
+   res.push_back(measure("adt7420_read_hang", [&] {
+      adt7420.read();
+   }));
+   emu_i2c_fault(EMU_I2C_OK);
+   adt7420.read();    // pointer back at the temperature register
+   i2c.set_freq(I2cCore::I2C_SPEED_STD);
+   // asynchronous read: one command issued per poll at a ready edge
+   res.push_back(measure("i2c_xfer_step", [&] {
+      if (!adt7420.read_busy())
+         adt7420.read_start();
+      i2c.poll();
+   }));
+   while (i2c.poll()) {
+   }
+   res.push_back(measure("uart_disp_double", [&] {
+      uart.disp(-23.4375);
+   }));
+   res.push_back(measure("uart_disp_int_base_len", [&] {
+      uart.disp(-12345, 10, 8);
+   }));
+   res.push_back(measure("uart_printf_q4", [&] {
+      uart.printf("%q4", -375);    // -23.4375 as in uart_disp_double
+   }));
+   res.push_back(measure("tlm_send_sample", [&] {
+      tlm_send(TLM_MODE_DIFF, 0x0c00, Temperature::from_mc(25000));
+   }));
+   uart.set_tx_policy(UartCore::TX_BLOCK);
+   res.push_back(measure("uart_disp_double_queue", [&] {
+      uart.disp(-23.4375);
+   }));
+   uart.set_tx_policy(UartCore::TX_SYNC);   // flush the ring
+   res.push_back(measure("xadc_read_temp", [&] {
+      xadc.read_temp_q7();
+   }));
+   res.push_back(measure("xadc_snapshot", [&] {
+      XadcSnap snap;
+      xadc.snapshot(&snap);
+   }));
+   acl.init();         // 5M Hz sclk
+   res.push_back(measure("spi_transfer_byte", [&] {
+      spi.transfer(0x00);
+   }));
+   res.push_back(measure("adxl362_read_xyz", [&] {
+      Adxl362Sample s;
+      acl.read_xyz(&s);
+   }));
+   // a settle period (300 ms @100 Hz) of x/y/z sets per drain
+   res.push_back(measure("adxl362_drain", [&] {
+      Adxl362Sample s[ACL_DRAIN_MAX];
+      acl.drain(s, ACL_DRAIN_MAX);
+   }));
+   // a changing digit; an unchanged high word is not written
+   int digit = 0;
+   res.push_back(measure("sseg_write_1ptn", [&] {
+      sseg.write_1ptn(sseg.h2s(digit++ & 0x0f), 3);
+   }));
+   // alternate patterns so that both words are written on every call
+   int frame = 0;
+   res.push_back(measure("sseg_write_8ptn", [&] {
+      sseg.write_8ptn(ptn[frame++ & 1]);
+   }));
+   // one display frame per sample; reading varies by 1/128 C
+   int32_t q7 = 25 * 128;
+   res.push_back(measure("sseg_temp_disp_c", [&] {
+      temp_disp_C(Temperature::from_q7(q7++), &sseg);
+   }));
+   res.push_back(measure("pwm_set_duty", [&] {
+      pwm.set_duty(512, 1);
+   }));
+   res.push_back(measure("gpo_write_bit", [&] {
+      led.write(1, 13);
+   }));
+   res.push_back(measure("gpi_read", [&] {
+      sw.read();
+   }));
+   res.push_back(measure("timer_read_time", [&] {
+      now_us();
+   }));
+   res.push_back(measure("timer_elapsed_ticks", [&] {
+      elapsed_ticks(0);
+   }));
+   res.push_back(measure("slot_timer_read_tick", [&] {
+      slot_timer.read_tick();
+   }));
+   res.push_back(measure("slot_uart_tx_byte", [&] {
+      slot_uart.tx_byte('.');
+   }));
+   res.push_back(measure("wheel_advance_idle", [&] {
+      sys_wheel.advance();
+   }));
+   sampler.start();
+   res.push_back(measure("sched_poll_idle", [&] {
+      sampler.poll();
+   }));
+   emu_set_btn(16);   // hold LIVE button
+   // one pass of the LIVE loop; the sensor read is spread over passes
+   res.push_back(measure("live_iteration", [&] {
+      service();
+      live_step(rst, live, z);
+   }));
+   emu_set_btn(0);
+   return (res);
+}
+
+// host time per filtered sample, each filter type; noisy input
+// around 25 C so that the median networks see unsorted data
+static void cpu_bench() {
+   static int32_t in[256];
+   volatile int32_t sink = 0;
+   uint32_t lfsr = 0xace1u;
+
+   for (int i = 0; i < 256; i++) {
+      lfsr = (lfsr >> 1) ^ (-(lfsr & 1u) & 0xb400u);
+      in[i] = 25 * 128 + (int32_t) (lfsr & 0x3f) - 32;
+   }
+   printf("\n%-24s %10s   %s\n", "cpu op (host)", "ns/call", "not compared");
+   for (int type = 0; type < FILT_NUM; type++) {
+      TempFilter f(type);
+      int32_t acc = 0;
+      auto t0 = std::chrono::steady_clock::now();
+      for (int i = 0; i < CPU_BENCH_SAMPLES; i++)
+         acc += f.step(in[i & 0xff]);
+      auto t1 = std::chrono::steady_clock::now();
+      sink = acc;
+      double ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+      std::string name = std::string("filter_step_") + TempFilter::name(type);
+      printf("%-24s %10.2f\n", name.c_str(), ns / CPU_BENCH_SAMPLES);
+   }
+   // add (evicting once full) plus slope, as per sample in the firmware
+   TempTrend tr(SAMPLE_MS);
+   int32_t acc = 0;
+   auto t0 = std::chrono::steady_clock::now();
+   for (int i = 0; i < CPU_BENCH_SAMPLES; i++) {
+      tr.add(in[i & 0xff]);
+      acc += tr.slope();
+   }
+   auto t1 = std::chrono::steady_clock::now();
+   sink = acc;
+   double ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+   printf("%-24s %10.2f\n", "trend_add_slope", ns / CPU_BENCH_SAMPLES);
+   (void) sink;
+}
+
+static int load_baseline(const char *path, std::vector<BenchResult> &base) {
+   FILE *fp;
+   char line[256], name[128];
+   unsigned long long a, c, b;
+
+   fp = fopen(path, "r");
+   if (!fp)
+      return (-1);
+   while (fgets(line, sizeof(line), fp)) {
+      if (line[0] == '#')
+         continue;
+      if (sscanf(line, "%127s %llu %llu %llu", name, &a, &c, &b) == 4) {
+         BenchResult r = {name, a, c, b};
+         base.push_back(r);
+      }
+   }
+   fclose(fp);
+   return (0);
+}
+
+static int save_baseline(const char *path, const std::vector<BenchResult> &res) {
+   FILE *fp;
+
+   fp = fopen(path, "w");
+   if (!fp)
+      return (-1);
+   fprintf(fp, "# driver_bench baseline: op accesses cycles bytes\n");
+   for (size_t i = 0; i < res.size(); i++)
+      fprintf(fp, "%s %llu %llu %llu\n", res[i].name.c_str(),
+            (unsigned long long) res[i].accesses,
+            (unsigned long long) res[i].cycles,
+            (unsigned long long) res[i].bytes);
+   fclose(fp);
+   return (0);
+}
+
+static const BenchResult *find(const std::vector<BenchResult> &v,
+      const std::string &name) {
+   for (size_t i = 0; i < v.size(); i++)
+      if (v[i].name == name)
+         return (&v[i]);
+   return (0);
+}
+
+int main(int argc, char *argv[]) {
+   const char *path = DEFAULT_BASELINE;
+   std::vector<BenchResult> res, base;
+   int update = 0, fail = 0;
+
+   for (int i = 1; i < argc; i++) {
+      if (strcmp(argv[i], "--update") == 0)
+         update = 1;
+      else
+         path = argv[i];
+   }
+   emu_uart_set_output(NULL);
+   pwm.init();
+   sseg.init();
+   res = run_all();
+   if (update) {
+      if (save_baseline(path, res) != 0) {
+         fprintf(stderr, "cannot write %s\n", path);
+         return (2);
+      }
+      printf("baseline written to %s\n", path);
+   }
+   if (load_baseline(path, base) != 0) {
+      fprintf(stderr, "cannot read baseline %s\n", path);
+      return (2);
+   }
+   printf("%-24s %10s %12s %6s   %s\n", "op", "accesses", "cycles", "bytes",
+         "baseline");
+   for (size_t i = 0; i < res.size(); i++) {
+      const BenchResult &r = res[i];
+      const BenchResult *b = find(base, r.name);
+      const char *status;
+
+      if (!b)
+         status = "(no baseline)";
+      else if (r.accesses > b->accesses || r.cycles > b->cycles
+            || r.bytes > b->bytes) {
+         status = "REGRESSION";
+         fail = 1;
+      } else
+         status = "ok";
+      printf("%-24s %10llu %12llu %6llu   ", r.name.c_str(),
+            (unsigned long long) r.accesses, (unsigned long long) r.cycles,
+            (unsigned long long) r.bytes);
+      if (b)
+         printf("%llu/%llu/%llu ", (unsigned long long) b->accesses,
+               (unsigned long long) b->cycles, (unsigned long long) b->bytes);
+      printf("%s\n", status);
+   }
+   cpu_bench();
+   return (fail);
+}
@@ -0,0 +1,120 @@
+/*****************************************************************//**
+ * @file log_cat.cpp
+ *
+ * @brief command-line decoder of sample log dumps
+ *
+ * Description:
+ *  - reads a console capture (file or stdin) containing log dumps
+ *    (console command 'l'; format in main_sampler_test.cpp) and
+ *    prints one CSV line per sample:
+ *      time_ms,raw,temp_C   (time since the first sample; the log
+ *                            holds new reads only, so steps vary)
+ *  - other console text around a dump is skipped
+ *  - -s: print a summary per dump only (samples, bytes, bytes/sample,
+ *    samples dropped once the log was full)
+ *
+ * Build and run from the repository root:
+ *    g++ -O2 -Icpp -Ihost host/log_cat.cpp cpp/temp_log.cpp -o log_cat
+ *    ./log_cat capture.txt
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "temp_log.h"
+#include "telemetry.h"
+
+static int hex_val(int c) {
+   if (c >= '0' && c <= '9')
+      return (c - '0');
+   if (c >= 'a' && c <= 'f')
+      return (c - 'a' + 10);
+   if (c >= 'A' && c <= 'F')
+      return (c - 'A' + 10);
+   return (-1);
+}
+
+// decode one dump; returns 0 if the whole log decoded
+static int decode(const std::vector<uint8_t> &buf, unsigned long count,
+      unsigned long nibbles, int res16, long period, unsigned long dropped,
+      int summary) {
+   TempLogReader rd(buf.data(), (uint32_t) nibbles, (uint32_t) count, res16);
+   uint16_t raw;
+   unsigned long n = 0, t0 = 0;
+   int rc;
+
+   if (nibbles > 2 * buf.size()) {
+      fprintf(stderr, "dump truncated: %lu of %lu nibbles\n",
+            (unsigned long) (2 * buf.size()), nibbles);
+      return (1);
+   }
+   while ((rc = rd.next(&raw)) == 1) {
+      if (n == 0)
+         t0 = rd.tick();
+      if (!summary)
+         printf("%lu,0x%04x,%.4f\n", (rd.tick() - t0) * period, raw,
+               tlm_raw_q7(raw, res16) / 128.0);
+      n++;
+   }
+   if (summary)
+      printf("samples %lu bytes %lu (%.2f bytes/sample) dropped %lu\n", n,
+            (nibbles + 1) / 2, n ? (nibbles / 2.0) / n : 0.0, dropped);
+   else if (dropped)
+      fprintf(stderr, "log full: %lu samples dropped\n", dropped);
+   if (rc < 0 || n != count) {
+      fprintf(stderr, "corrupt log at sample %lu of %lu\n", n, count);
+      return (1);
+   }
+   return (0);
+}
+
+int main(int argc, char *argv[]) {
+   const char *path = 0;
+   int summary = 0, fail = 0, dumps = 0;
+   char line[256];
+   FILE *fp;
+
+   for (int i = 1; i < argc; i++) {
+      if (strcmp(argv[i], "-s") == 0)
+         summary = 1;
+      else
+         path = argv[i];
+   }
+   fp = path ? fopen(path, "r") : stdin;
+   if (!fp) {
+      fprintf(stderr, "cannot open %s\n", path);
+      return (2);
+   }
+   while (fgets(line, sizeof(line), fp)) {
+      unsigned long count, nibbles, dropped;
+      int res16;
+      long period;
+      char *hdr = strstr(line, "log ");
+
+      if (!hdr || sscanf(hdr, "log %lu %lu %d %ld %lu", &count, &nibbles,
+            &res16, &period, &dropped) != 5)
+         continue;
+      // hex lines up to "end"
+      std::vector<uint8_t> buf;
+      // (the console ends lines with "\n\r": skip leading blanks)
+      while (fgets(line, sizeof(line), fp)) {
+         char *p = line + strspn(line, " \t\r\n");
+         if (strncmp(p, "end", 3) == 0)
+            break;
+         for (; hex_val(p[0]) >= 0 && hex_val(p[1]) >= 0; p += 2)
+            buf.push_back((uint8_t) (hex_val(p[0]) << 4 | hex_val(p[1])));
+      }
+      fail |= decode(buf, count, nibbles, res16, period, dropped, summary);
+      dumps++;
+   }
+   if (path)
+      fclose(fp);
+   if (dumps == 0) {
+      fprintf(stderr, "no log dump found\n");
+      return (1);
+   }
+   return (fail);
+}
@@ -0,0 +1,114 @@
+/*****************************************************************//**
+ * @file tlm_cat.cpp
+ *
+ * @brief command-line decoder of the binary telemetry stream
+ *
+ * Description:
+ *  - reads a telemetry stream (serial port device, capture file or
+ *    stdin) and prints one CSV line per sample record:
+ *      time_us,mode,raw,temp_C,baseline_C,shown_C,status
+ *    (temp_C from raw; shown_C the filtered value on the display;
+ *    status ok, stale or backup)
+ *  - -c: print statistics and decode rate only
+ *  - -g N: write N synthetic frames to stdout (for testing)
+ *
+ * Build and run from the repository root:
+ *    g++ -O2 -Icpp -Ihost host/tlm_cat.cpp host/tlm_decode.cpp \
+ *        cpp/chu_cobs.cpp -o tlm_cat
+ *    stty -F /dev/ttyUSB1 9600 raw && ./tlm_cat /dev/ttyUSB1
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "tlm_decode.h"
+
+#define SYS_CLK_MHZ 100     // SYS_CLK_FREQ of the firmware
+
+static const char *const MODE_NAME[8] =
+   {"idle", "live", "avg", "diff", "4", "5", "6", "7"};
+
+static void print_sample(const tlm_sample_t *r, void *arg) {
+   FILE *fp = (FILE *) arg;
+   double t_us = (double) ((uint64_t) r->ts << TLM_TS_SHIFT) / SYS_CLK_MHZ;
+
+   const char *status = (r->status & TLM_STAT_BACKUP) ? "backup" :
+                        (r->status & TLM_STAT_STALE) ? "stale" : "ok";
+
+   fprintf(fp, "%.0f,%s,0x%04x,%.4f,%.4f,%.4f,%s\n", t_us, MODE_NAME[r->mode],
+         r->raw, tlm_raw_q7(r->raw, r->res16) / 128.0, r->baseline / 128.0,
+         r->temp / 128.0, status);
+}
+
+// n frames with varying content, as the firmware would send
+static int generate(long n) {
+   uint8_t payload[TLM_SAMPLE_LEN], frame[COBS_ENC_LEN(TLM_SAMPLE_LEN + 2) + 1];
+   tlm_sample_t r;
+   int len;
+
+   for (long i = 0; i < n; i++) {
+      r.mode = (uint8_t) (i & 3);
+      r.res16 = 0;
+      r.ts = (uint32_t) (i * 48828);   // 500 ms period
+      r.raw = (uint16_t) ((384 + (i % 40)) << 3);   // 24.0 C and up
+      r.baseline = (int16_t) (24 * 128 + (i % 7));
+      r.temp = (int16_t) ((384 + (i % 40)) << 3);
+      r.status = (i % 50 == 49) ? TLM_STAT_STALE : 0;
+      tlm_pack(&r, payload);
+      len = cobs_frame(payload, TLM_SAMPLE_LEN, frame);
+      fwrite(frame, 1, (size_t) len, stdout);
+   }
+   return (0);
+}
+
+int main(int argc, char *argv[]) {
+   static uint8_t buf[1 << 16];
+   const char *path = 0;
+   int count_only = 0;
+   int fd;
+   ssize_t n;
+
+   for (int i = 1; i < argc; i++) {
+      if (strcmp(argv[i], "-c") == 0)
+         count_only = 1;
+      else if (strcmp(argv[i], "-g") == 0 && i + 1 < argc)
+         return (generate(atol(argv[++i])));
+      else
+         path = argv[i];
+   }
+   // read() returns what is available: no wait on a live port
+   fd = path ? open(path, O_RDONLY) : 0;
+   if (fd < 0) {
+      fprintf(stderr, "cannot open %s\n", path);
+      return (2);
+   }
+   if (!count_only)
+      setvbuf(stdout, 0, _IOFBF, 1 << 16);
+   TlmDecoder dec(count_only ? 0 : print_sample, stdout);
+   clock_t c0 = clock();
+   while ((n = read(fd, buf, sizeof(buf))) > 0) {
+      dec.feed(buf, (size_t) n);
+      if (!count_only)
+         fflush(stdout);   // keep up with a live port
+   }
+   double sec = (double) (clock() - c0) / CLOCKS_PER_SEC;
+   const TlmStats &st = dec.stats();
+   fprintf(count_only ? stdout : stderr,
+         "bytes %llu frames %llu samples %llu crc_err %llu bad %llu "
+         "unknown %llu",
+         (unsigned long long) st.bytes, (unsigned long long) st.frames,
+         (unsigned long long) st.samples, (unsigned long long) st.crc_err,
+         (unsigned long long) st.bad, (unsigned long long) st.unknown);
+   if (sec > 0)
+      fprintf(count_only ? stdout : stderr, " (%.1f Mbit/s)",
+            st.bytes * 8.0 / sec / 1e6);
+   fprintf(count_only ? stdout : stderr, "\n");
+   if (path)
+      close(fd);
+   return (st.crc_err ? 1 : 0);
+}
@@ -0,0 +1,78 @@
+/*****************************************************************//**
+ * @file tlm_decode.cpp
+ *
+ * @brief implementation of the telemetry stream decoder
+ *
+ * @version v1.0: initial release
+ ********************************************************************/
+
+#include <string.h>
+#include "tlm_decode.h"
+
+TlmDecoder::TlmDecoder(Handler h, void *arg) {
+   handler = h;
+   handler_arg = arg;
+   len = 0;
+   overflow = false;
+   memset(&st, 0, sizeof(st));
+}
+
+// a complete frame (delimiter excluded) in src[0..n)
+void TlmDecoder::end_frame(const uint8_t *src, size_t n) {
+   uint8_t payload[FRAME_MAX];
+   tlm_sample_t rec;
+   int k;
+
+   if (n == 0)           // back-to-back delimiters
+      return;
+   k = cobs_unframe(src, (int) n, payload);
+   if (k == -2) {
+      st.crc_err++;
+      return;
+   }
+   if (k < 0) {
+      st.bad++;
+      return;
+   }
+   st.frames++;
+   if (tlm_unpack(payload, k, &rec) != 0) {
+      st.unknown++;
+      return;
+   }
+   st.samples++;
+   if (handler)
+      handler(&rec, handler_arg);
+}
+
+void TlmDecoder::feed(const uint8_t *data, size_t n) {
+   const uint8_t *p = data, *end = data + n, *z;
+   size_t k;
+
+   st.bytes += n;
+   while (p < end) {
+      z = (const uint8_t *) memchr(p, 0, (size_t) (end - p));
+      k = (size_t) ((z ? z : end) - p);
+      if (!overflow && len == 0 && z && k <= FRAME_MAX) {
+         // whole frame inside this block: decode without copying
+         end_frame(p, k);
+      } else {
+         if (!overflow && len + k <= FRAME_MAX) {
+            memcpy(frame + len, p, k);
+            len += k;
+         } else {
+            overflow = true;
+         }
+         if (z) {
+            if (overflow)
+               st.bad++;
+            else
+               end_frame(frame, len);
+            len = 0;
+            overflow = false;
+         }
+      }
+      if (!z)
+         break;
+      p = z + 1;
+   }
+}
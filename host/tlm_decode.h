@@ -0,0 +1,82 @@
+/*****************************************************************//**
+ * @file tlm_decode.h
+ *
+ * @brief host-side decoder of the binary telemetry stream
+ *
+ * Description:
+ *  - splits a byte stream at 0x00 delimiters, COBS-decodes and
+ *    CRC-checks each frame (cpp/chu_cobs.h) and unpacks sample
+ *    records (cpp/telemetry.h)
+ *  - stream can be fed in blocks of any size; partial frames are
+ *    kept between calls
+ *  - bytes before the first delimiter (e.g., text output before
+ *    binary mode was selected) are counted as a bad frame
+ *  - no allocation; frame search with memchr()
+ *
+ * @version v1.0: initial release
+ *********************************************************************/
+
+#ifndef _TLM_DECODE_H_INCLUDED
+#define _TLM_DECODE_H_INCLUDED
+
+#include <stddef.h>
+#include "chu_cobs.h"
+#include "telemetry.h"
+
+/**
+ * decoder statistics
+ */
+struct TlmStats {
+   uint64_t bytes;      // # bytes fed
+   uint64_t frames;     // # frames passing the crc check
+   uint64_t samples;    // # sample records delivered
+   uint64_t crc_err;    // # frames failing the crc check
+   uint64_t bad;        // # malformed/overlong frames
+   uint64_t unknown;    // # valid frames of unknown type
+};
+
+class TlmDecoder {
+public:
+   /**
+    * sample record handler
+    * @param rec decoded record
+    * @param arg argument given to the constructor
+    */
+   typedef void (*Handler)(const tlm_sample_t *rec, void *arg);
+
+   /**
+    * constructor.
+    * @param h handler called for each sample record (may be 0)
+    * @param arg argument passed to handler
+    */
+   TlmDecoder(Handler h, void *arg);
+
+   /**
+    * feed stream bytes
+    * @param data bytes
+    * @param n # bytes
+    */
+   void feed(const uint8_t *data, size_t n);
+
+   /**
+    * statistics since construction
+    */
+   const TlmStats &stats() const {
+      return (st);
+   }
+
+private:
+   enum {
+      FRAME_MAX = COBS_ENC_LEN(COBS_MAX_DATA)  // longest valid frame
+   };
+   Handler handler;
+   void *handler_arg;
+   uint8_t frame[FRAME_MAX];
+   size_t len;          // # bytes of current frame
+   bool overflow;       // current frame too long; discarded
+   TlmStats st;
+
+   void end_frame(const uint8_t *src, size_t n);
+};
+
+#endif  // _TLM_DECODE_H_INCLUDED